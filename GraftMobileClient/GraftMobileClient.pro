@@ -1,4 +1,4 @@
-QT += qml quick network
+QT += qml quick network websockets
 
 CONFIG += c++11
 
@@ -28,6 +28,17 @@ HEADERS += \
     core/api/graftposapi.h \
     core/graftposclient.h \
     core/defines.h
+
+# Builds with CONFIG+=sql_catalog keep the catalog in an SQLite database that can be sorted
+# and filtered instead of the binary snapshot.
+sql_catalog {
+QT += sql
+DEFINES += SQL_PRODUCT_CATALOG
+
+SOURCES += core/sqlproductstore.cpp
+
+HEADERS += core/sqlproductstore.h
+}
 }
 
 contains(DEFINES, WALLET_BUILD) {
@@ -44,6 +55,12 @@ HEADERS += \
 
 SOURCES += main.cpp \
     core/api/graftgenericapi.cpp \
+    core/api/supernodepool.cpp \
+    core/api/graftapithread.cpp \
+    core/api/statussubscription.cpp \
+    core/api/requeststatistics.cpp \
+    core/api/jsonrpcwriter.cpp \
+    core/api/jsonresultreader.cpp \
     core/productmodel.cpp \
     core/productitem.cpp \
     core/productmodelserializator.cpp \
@@ -53,6 +70,14 @@ SOURCES += main.cpp \
     core/cardmodel.cpp \
     core/keygenerator.cpp \
     core/selectedproductproxymodel.cpp \
+    core/productsearchindex.cpp \
+    core/productsearchmodel.cpp \
+    core/binaryproductstore.cpp \
+    core/productjournal.cpp \
+    core/memoryproductstore.cpp \
+    core/thumbnailimageprovider.cpp \
+    core/salepayload.cpp \
+    core/pagedproductmodel.cpp \
     designfactory.cpp \
     core/currencymodel.cpp \
     core/currencyitem.cpp \
@@ -62,11 +87,19 @@ SOURCES += main.cpp \
     core/quickexchangemodel.cpp \
     core/accountmodelserializator.cpp \
     core/accountmanager.cpp \
-    core/qrcodegenerator.cpp
+    core/qrcodegenerator.cpp \
+    core/statuspoller.cpp \
+    core/logger.cpp
 
 HEADERS += \
     core/config.h \
     core/api/graftgenericapi.h \
+    core/api/supernodepool.h \
+    core/api/graftapithread.h \
+    core/api/statussubscription.h \
+    core/api/requeststatistics.h \
+    core/api/jsonrpcwriter.h \
+    core/api/jsonresultreader.h \
     core/productmodel.h \
     core/productitem.h \
     core/productmodelserializator.h \
@@ -76,6 +109,15 @@ HEADERS += \
     core/cardmodel.h \
     core/keygenerator.h \
     core/selectedproductproxymodel.h \
+    core/productsearchindex.h \
+    core/productsearchmodel.h \
+    core/productstore.h \
+    core/binaryproductstore.h \
+    core/productjournal.h \
+    core/memoryproductstore.h \
+    core/thumbnailimageprovider.h \
+    core/salepayload.h \
+    core/pagedproductmodel.h \
     designfactory.h \
     core/currencymodel.h \
     core/currencyitem.h \
@@ -86,7 +128,9 @@ HEADERS += \
     core/accountmodelserializator.h \
     core/accountmanager.h \
     core/graftclienttools.h \
-    core/qrcodegenerator.h
+    core/qrcodegenerator.h \
+    core/statuspoller.h \
+    core/logger.h
 
 include(resources/resources.pri)
 
@@ -102,6 +146,10 @@ QML_DESIGNER_IMPORT_PATH =
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# Debug level logging is compiled out of release builds, info and above still reach the
+# in-memory log buffer.
+CONFIG(release, debug|release): DEFINES += QT_NO_DEBUG_OUTPUT
+
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
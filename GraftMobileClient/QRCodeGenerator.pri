@@ -2,8 +2,6 @@
 #Author: Nayuki
 #Link to original repository: https://github.com/nayuki/QR-Code-generator
 
-QT += svg
-
 INCLUDEPATH += $$PWD/qrcodegenerator/cpp/
 
 SOURCES += \
@@ -0,0 +1,75 @@
+#include "qrcodegenerator.h"
+#include "salepayload.h"
+
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+
+static const int scDefaultIterations = 200;
+static const int scSizes[] = {160, 300, 540};
+
+namespace {
+// Sale payloads as built by GraftPOSClient::receiveSale: pid;address;amount;block.
+QStringList salePayloads()
+{
+    const QString address("GBxuJaAhvPHGGvLbtWnWr8nKjyBtfsVqwcWGxMszjvhVcvdp9iBuAefHNLZUxKqLcNXk"
+                          "2ZtyaXJ5WXYGQ6u3uQ1zByvmNWv");
+    return {
+        QStringLiteral("3f2b7c1e-8d4a-4b6f-9e21-5a7c3d9e0b14;%1;5;104532").arg(address),
+        QStringLiteral("a91c0e57-2b3f-4c8d-b6e4-07d95f1a2c68;%1;149.99;104533").arg(address),
+        QStringLiteral("e0d4b8a2-6c1f-47e3-8a95-c2b1f0d3e7a9;%1;12345.678901;1048576")
+            .arg(address)
+    };
+}
+
+double percentile(QVector<qint64> samples, double fraction)
+{
+    std::sort(samples.begin(), samples.end());
+    const int index = qMin(samples.count() - 1, int(fraction * samples.count()));
+    return samples.at(index) / 1000.0;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const int iterations = argc > 1 ? qMax(1, QString(argv[1]).toInt()) : scDefaultIterations;
+    QRCodeGenerator encoder;
+    QTextStream out(stdout);
+    out << "format, payload chars, symbol px, size px, median us, p95 us, max us" << endl;
+    for (const QString &text : salePayloads())
+    {
+        // The legacy text is encoded the way it was, the compact one as GraftPOSClient does now.
+        const QString compactText = SalePayload::fromText(text).toCompactText();
+        const QVector<QPair<QString, QRCodeGenerator::ErrorCorrection>> formats = {
+            {text, QRCodeGenerator::Quartile},
+            {compactText, QRCodeGenerator::Adaptive}
+        };
+        for (int size : scSizes)
+        {
+            for (const QPair<QString, QRCodeGenerator::ErrorCorrection> &format : formats)
+            {
+                const QString &payload = format.first;
+                QVector<qint64> samples;
+                samples.reserve(iterations);
+                // The first encode warms up allocations and isn't measured.
+                const int symbolSize = encoder.encode(payload, 0, format.second).width();
+                for (int i = 0; i < iterations; ++i)
+                {
+                    QElapsedTimer timer;
+                    timer.start();
+                    const QImage image = encoder.encode(payload, size, format.second);
+                    samples.append(timer.nsecsElapsed());
+                    Q_UNUSED(image);
+                }
+                out << (format.second == QRCodeGenerator::Adaptive ? "compact" : "legacy") << ", "
+                    << payload.size() << ", " << symbolSize << ", " << size << ", "
+                    << percentile(samples, 0.5) << ", " << percentile(samples, 0.95) << ", "
+                    << percentile(samples, 1.0) << endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+# Measures QR encode and render latency of sale payloads, it isn't part of the application
+# build. Run it from a release build: qmake && make && ./qrencode [iterations]
+
+QT += gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = qrencode
+
+include(../../QRCodeGenerator.pri)
+
+INCLUDEPATH += ../../core
+
+SOURCES += \
+    main.cpp \
+    ../../core/qrcodegenerator.cpp \
+    ../../core/salepayload.cpp
+
+HEADERS += \
+    ../../core/qrcodegenerator.h \
+    ../../core/salepayload.h
@@ -0,0 +1,477 @@
+#include "api/statussubscription.h"
+#include "statuspoller.h"
+
+#include <QCoreApplication>
+#include <QWebSocketServer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QStringList>
+#include <QWebSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QEventLoop>
+#include <QVector>
+#include <QTimer>
+#include <QPair>
+#include <QHash>
+
+#include <functional>
+
+static const int scTimeout = 3000;
+static const int scPollInterval = 50;
+static const int scServePushDelay = 2000;
+static const QString scPid("3f2b7c1e-8d4a-4b6f-9e21-5a7c3d9e0b14");
+// Values of GraftGenericAPI::OperationStatus.
+static const int scStatusProcessing = 1;
+static const int scStatusApproved = 2;
+static const int scMethodNotFound = -32601;
+static const int scPaymentNotFound = -32000;
+
+namespace {
+// Answers subscriptions like a supernode: a result carrying the PaymentID acknowledges one,
+// results with a Status push the changes.
+class StandInServer
+{
+public:
+    enum Mode
+    {
+        AcceptMode,
+        MethodNotFoundMode,
+        PaymentNotFoundMode
+    };
+
+    StandInServer()
+        : mServer(QStringLiteral("statusserver"), QWebSocketServer::NonSecureMode)
+        ,mMode(AcceptMode)
+        ,mConnectionCount(0)
+    {
+        QObject::connect(&mServer, &QWebSocketServer::newConnection, [this] { accept(); });
+    }
+
+    bool listen(quint16 port = 0)
+    {
+        return mServer.listen(QHostAddress::LocalHost, port);
+    }
+
+    QUrl serviceUrl() const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1/dapi").arg(mServer.serverPort()));
+    }
+
+    void setMode(Mode mode)
+    {
+        mMode = mode;
+    }
+
+    void setSubscribedHandler(const std::function<void(const QString &)> &handler)
+    {
+        mSubscribedHandler = handler;
+    }
+
+    int connectionCount() const
+    {
+        return mConnectionCount;
+    }
+
+    int openConnectionCount() const
+    {
+        return mSockets.count();
+    }
+
+    QString requestPath() const
+    {
+        return mRequestPath;
+    }
+
+    QStringList methods() const
+    {
+        return mMethods;
+    }
+
+    void push(const QString &pid, int status)
+    {
+        QWebSocket *socket = mSubscribers.value(pid);
+        if (socket)
+        {
+            QJsonObject result;
+            result.insert(QStringLiteral("PaymentID"), pid);
+            result.insert(QStringLiteral("Status"), status);
+            send(socket, pid, QStringLiteral("result"), result);
+        }
+    }
+
+    void dropConnections()
+    {
+        for (QWebSocket *socket : mSockets)
+        {
+            socket->close(QWebSocketProtocol::CloseCodeGoingAway);
+        }
+    }
+
+private:
+    void accept()
+    {
+        while (mServer.hasPendingConnections())
+        {
+            QWebSocket *socket = mServer.nextPendingConnection();
+            ++mConnectionCount;
+            mRequestPath = socket->requestUrl().path();
+            mSockets.append(socket);
+            QObject::connect(socket, &QWebSocket::textMessageReceived,
+                             [this, socket](const QString &message) {
+                receive(socket, message);
+            });
+            QObject::connect(socket, &QWebSocket::disconnected, [this, socket] {
+                mSockets.removeOne(socket);
+                for (const QString &pid : mSubscribers.keys(socket))
+                {
+                    mSubscribers.remove(pid);
+                }
+                socket->deleteLater();
+            });
+        }
+    }
+
+    void receive(QWebSocket *socket, const QString &message)
+    {
+        const QJsonObject request = QJsonDocument::fromJson(message.toUtf8()).object();
+        const QString method = request.value(QLatin1String("method")).toString();
+        const QString pid = request.value(QLatin1String("params")).toObject()
+                .value(QLatin1String("PaymentID")).toString();
+        const QString id = request.value(QLatin1String("id")).toString();
+        mMethods.append(method);
+        if (mMode != AcceptMode)
+        {
+            const bool isMethodNotFound = mMode == MethodNotFoundMode;
+            QJsonObject error;
+            error.insert(QStringLiteral("code"),
+                         isMethodNotFound ? scMethodNotFound : scPaymentNotFound);
+            error.insert(QStringLiteral("message"),
+                         isMethodNotFound ? QStringLiteral("Method not found")
+                                          : QStringLiteral("Payment not found"));
+            send(socket, id, QStringLiteral("error"), error);
+        }
+        else if (method == QLatin1String("Unsubscribe"))
+        {
+            mSubscribers.remove(pid);
+        }
+        else
+        {
+            mSubscribers.insert(pid, socket);
+            QJsonObject result;
+            result.insert(QStringLiteral("PaymentID"), pid);
+            send(socket, id, QStringLiteral("result"), result);
+            if (mSubscribedHandler)
+            {
+                mSubscribedHandler(pid);
+            }
+        }
+    }
+
+    void send(QWebSocket *socket, const QString &id, const QString &key,
+              const QJsonObject &value)
+    {
+        QJsonObject response;
+        response.insert(QStringLiteral("jsonrpc"), QStringLiteral("2.0"));
+        response.insert(QStringLiteral("id"), id);
+        response.insert(key, value);
+        socket->sendTextMessage(
+                    QString::fromUtf8(QJsonDocument(response).toJson(QJsonDocument::Compact)));
+    }
+
+    QWebSocketServer mServer;
+    Mode mMode;
+    int mConnectionCount;
+    QString mRequestPath;
+    QStringList mMethods;
+    QList<QWebSocket *> mSockets;
+    QHash<QString, QWebSocket *> mSubscribers;
+    std::function<void(const QString &)> mSubscribedHandler;
+};
+
+// A subscription and a poller wired together the way GraftPOSClient does it, the status
+// requests of the poller are answered with "still processing" right away.
+class Client
+{
+public:
+    explicit Client(const QUrl &url)
+        : subscription(QStringLiteral("SubscribeSaleStatus"), QStringLiteral("2.0"))
+        ,subscribedCount(0)
+        ,failedCount(0)
+    {
+        poller.setInitialInterval(scPollInterval);
+        poller.setMaxInterval(scPollInterval);
+        poller.setJitter(0);
+        poller.setDeadline(0);
+        subscription.setUrl(url);
+        QObject::connect(&subscription, &StatusSubscription::subscribed,
+                         &poller, &StatusPoller::suspend);
+        QObject::connect(&subscription, &StatusSubscription::failed,
+                         &poller, &StatusPoller::resume);
+        QObject::connect(&subscription, &StatusSubscription::subscribed,
+                         [this] { ++subscribedCount; });
+        QObject::connect(&subscription, &StatusSubscription::failed, [this] { ++failedCount; });
+        QObject::connect(&subscription, &StatusSubscription::statusReceived,
+                         [this](const QString &, int status) { statuses.append(status); });
+        QObject::connect(&poller, &StatusPoller::pollRequested, [this](const QString &pid) {
+            QTimer::singleShot(0, &poller, [this, pid] { poller.next(pid); });
+        });
+    }
+
+    void start()
+    {
+        poller.start(scPid);
+        subscription.subscribe(scPid);
+    }
+
+    int pollCount() const
+    {
+        return poller.pollCount(scPid);
+    }
+
+    StatusSubscription subscription;
+    StatusPoller poller;
+    int subscribedCount;
+    int failedCount;
+    QList<int> statuses;
+};
+
+bool waitFor(const std::function<bool()> &condition, int timeout = scTimeout)
+{
+    QEventLoop loop;
+    QTimer check;
+    QObject::connect(&check, &QTimer::timeout, [&] {
+        if (condition())
+        {
+            loop.quit();
+        }
+    });
+    check.start(10);
+    QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+    if (!condition())
+    {
+        loop.exec();
+    }
+    return condition();
+}
+
+void settle(int msec)
+{
+    waitFor([] { return false; }, msec);
+}
+
+void expect(bool condition, const QString &what, QStringList &failures)
+{
+    if (!condition)
+    {
+        failures.append(what);
+    }
+}
+
+void push(StandInServer &server, QStringList &failures)
+{
+    Client client(server.serviceUrl());
+    client.start();
+    expect(waitFor([&] { return client.subscribedCount == 1; }), "not subscribed", failures);
+    expect(server.requestPath() == QLatin1String("/dapi/subscribe"),
+           "connected to " + server.requestPath(), failures);
+    expect(server.methods().value(0) == QLatin1String("SubscribeSaleStatus"),
+           "subscribed with " + server.methods().value(0), failures);
+    const int pollCount = client.pollCount();
+    settle(scPollInterval * 4);
+    expect(client.pollCount() == pollCount, "kept polling while subscribed", failures);
+    server.push(scPid, scStatusProcessing);
+    server.push(scPid, scStatusApproved);
+    expect(waitFor([&] { return client.statuses.count() == 2; }), "no pushed status", failures);
+    expect(client.statuses == QList<int>({scStatusProcessing, scStatusApproved}),
+           "pushed statuses out of order", failures);
+    client.poller.stop(scPid);
+    client.subscription.unsubscribe(scPid);
+    expect(waitFor([&] { return server.openConnectionCount() == 0; }),
+           "connection kept after the last unsubscribe", failures);
+    expect(server.methods().contains(QStringLiteral("Unsubscribe")), "no Unsubscribe", failures);
+}
+
+void reconnect(StandInServer &server, QStringList &failures)
+{
+    Client client(server.serviceUrl());
+    client.start();
+    expect(waitFor([&] { return client.subscribedCount == 1; }), "not subscribed", failures);
+    const int pollCount = client.pollCount();
+    const int connectionCount = server.connectionCount();
+    server.dropConnections();
+    expect(waitFor([&] { return client.failedCount == 1; }), "no failure on disconnect",
+           failures);
+    expect(client.subscription.isSupported(), "a dropped connection disabled subscriptions",
+           failures);
+    expect(waitFor([&] { return client.pollCount() > pollCount + 1; }),
+           "polling didn't resume after disconnect", failures);
+    expect(waitFor([&] { return client.subscribedCount == 2; }), "not subscribed again",
+           failures);
+    expect(server.connectionCount() == connectionCount + 1, "didn't reconnect", failures);
+    const int resumedPollCount = client.pollCount();
+    settle(scPollInterval * 4);
+    expect(client.pollCount() == resumedPollCount, "kept polling after reconnect", failures);
+    server.push(scPid, scStatusApproved);
+    expect(waitFor([&] { return client.statuses.count() == 1; }),
+           "no pushed status after reconnect", failures);
+    client.poller.stop(scPid);
+    client.subscription.unsubscribe(scPid);
+    waitFor([&] { return server.openConnectionCount() == 0; });
+}
+
+void methodNotFound(StandInServer &server, QStringList &failures)
+{
+    server.setMode(StandInServer::MethodNotFoundMode);
+    Client client(server.serviceUrl());
+    client.start();
+    expect(waitFor([&] { return client.failedCount == 1; }), "no failure on rejection",
+           failures);
+    expect(!client.subscription.isSupported(), "an unknown method kept subscriptions on",
+           failures);
+    expect(waitFor([&] { return client.pollCount() > 2; }), "not polling after rejection",
+           failures);
+    const int connectionCount = server.connectionCount();
+    client.subscription.subscribe(scPid);
+    expect(client.failedCount == 2, "no immediate failure once unsupported", failures);
+    settle(scPollInterval * 2);
+    expect(server.connectionCount() == connectionCount, "connected although unsupported",
+           failures);
+    client.poller.stop(scPid);
+    server.setMode(StandInServer::AcceptMode);
+    waitFor([&] { return server.openConnectionCount() == 0; });
+}
+
+void paymentNotFound(StandInServer &server, QStringList &failures)
+{
+    server.setMode(StandInServer::PaymentNotFoundMode);
+    Client client(server.serviceUrl());
+    client.start();
+    expect(waitFor([&] { return client.failedCount == 1; }), "no failure on rejection",
+           failures);
+    expect(client.subscription.isSupported(), "an error for one PID disabled subscriptions",
+           failures);
+    expect(waitFor([&] { return client.pollCount() > 2; }), "not polling after rejection",
+           failures);
+    server.setMode(StandInServer::AcceptMode);
+    const QString pid = scPid + QStringLiteral("-next");
+    client.subscription.subscribe(pid);
+    expect(waitFor([&] { return client.subscription.isSubscribed(pid); }),
+           "next PID not subscribed", failures);
+    client.poller.stop(scPid);
+    client.subscription.unsubscribe(pid);
+    waitFor([&] { return server.openConnectionCount() == 0; });
+}
+
+void endpointNotFound(StandInServer &, QStringList &failures)
+{
+    // A supernode without the endpoint answers the upgrade like any unknown path.
+    QTcpServer http;
+    http.listen(QHostAddress::LocalHost);
+    QObject::connect(&http, &QTcpServer::newConnection, [&http] {
+        QTcpSocket *socket = http.nextPendingConnection();
+        QObject::connect(socket, &QTcpSocket::readyRead, [socket] {
+            socket->readAll();
+            socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+                          "Connection: close\r\n\r\n");
+            socket->disconnectFromHost();
+        });
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    });
+    Client client(QUrl(QStringLiteral("http://127.0.0.1:%1/dapi").arg(http.serverPort())));
+    client.start();
+    expect(waitFor([&] { return client.failedCount == 1; }), "no failure on 404", failures);
+    expect(!client.subscription.isSupported(), "a missing endpoint kept subscriptions on",
+           failures);
+    expect(waitFor([&] { return client.pollCount() > 2; }), "not polling after 404",
+           failures);
+    client.poller.stop(scPid);
+}
+
+void unavailable(StandInServer &, QStringList &failures)
+{
+    // Nothing listens on the port of a closed server until it is opened again.
+    quint16 port = 0;
+    QUrl url;
+    {
+        StandInServer closed;
+        closed.listen();
+        port = static_cast<quint16>(closed.serviceUrl().port());
+        url = closed.serviceUrl();
+    }
+    Client client(url);
+    client.start();
+    expect(waitFor([&] { return client.failedCount == 1; }, scTimeout * 3),
+           "no failure without a server", failures);
+    expect(client.subscription.isSupported(), "a refused connection disabled subscriptions",
+           failures);
+    expect(waitFor([&] { return client.pollCount() > 2; }), "not polling without a server",
+           failures);
+    StandInServer server;
+    expect(server.listen(port), "port couldn't be opened again", failures);
+    expect(waitFor([&] { return client.subscribedCount == 1; }, scTimeout * 3),
+           "not subscribed once the server is back", failures);
+    client.poller.stop(scPid);
+    client.subscription.unsubscribe(scPid);
+    waitFor([&] { return server.openConnectionCount() == 0; });
+}
+
+int serve(quint16 port)
+{
+    StandInServer server;
+    if (!server.listen(port))
+    {
+        QTextStream(stderr) << "Can't listen on port " << port << endl;
+        return 1;
+    }
+    // Every sale or payment moves to processing and is approved a little later.
+    server.setSubscribedHandler([&server](const QString &pid) {
+        QTimer::singleShot(scServePushDelay, [&server, pid] {
+            server.push(pid, scStatusProcessing);
+        });
+        QTimer::singleShot(scServePushDelay * 2, [&server, pid] {
+            server.push(pid, scStatusApproved);
+        });
+    });
+    QTextStream(stdout) << "Serving " << StatusSubscription::subscriptionUrl(server.serviceUrl())
+                                         .toString() << endl;
+    return QCoreApplication::exec();
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    const QStringList arguments = application.arguments();
+    if (arguments.value(1) == QLatin1String("--serve"))
+    {
+        return serve(static_cast<quint16>(arguments.value(2, QStringLiteral("28690")).toUInt()));
+    }
+    StandInServer server;
+    if (!server.listen())
+    {
+        QTextStream(stderr) << "Can't listen on a local port" << endl;
+        return 1;
+    }
+    const QVector<QPair<QString, std::function<void(StandInServer &, QStringList &)>>>
+            scenarios = {
+        {QStringLiteral("push"), push},
+        {QStringLiteral("reconnect"), reconnect},
+        {QStringLiteral("method not found"), methodNotFound},
+        {QStringLiteral("payment not found"), paymentNotFound},
+        {QStringLiteral("endpoint not found"), endpointNotFound},
+        {QStringLiteral("unavailable"), unavailable}
+    };
+    QTextStream out(stdout);
+    int failed = 0;
+    for (const auto &scenario : scenarios)
+    {
+        QStringList failures;
+        scenario.second(server, failures);
+        out << scenario.first << ": " << (failures.isEmpty() ? QStringLiteral("ok")
+                                                             : failures.join(", ")) << endl;
+        failed += failures.isEmpty() ? 0 : 1;
+    }
+    return failed;
+}
@@ -0,0 +1,23 @@
+# Stand-in for the supernode /dapi/subscribe endpoint, it isn't part of the application build.
+# ./statusserver runs StatusSubscription through push, reconnect and polling fallback scenarios,
+# ./statusserver --serve [port] only serves subscriptions for a client pointed at the port.
+
+QT += network websockets
+QT -= gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = statusserver
+
+INCLUDEPATH += ../../core
+
+SOURCES += \
+    main.cpp \
+    ../../core/api/statussubscription.cpp \
+    ../../core/statuspoller.cpp \
+    ../../core/logger.cpp
+
+HEADERS += \
+    ../../core/api/statussubscription.h \
+    ../../core/statuspoller.h \
+    ../../core/logger.h
@@ -1,25 +1,61 @@
 #include "accountmanager.h"
 #include "keygenerator.h"
 #include <QStandardPaths>
+#include <QMutexLocker>
 #include <QDataStream>
+#include <QSaveFile>
 #include <QFileInfo>
+#include <QRunnable>
 #include <QFile>
 #include <QDir>
 
 static const QString scAccountDataFile("account.dat");
 
+class AccountManager::Writer : public QRunnable
+{
+public:
+    explicit Writer(const AccountManager *manager)
+        : mManager(manager)
+    {
+    }
+
+    void run() override
+    {
+        mManager->writePending();
+    }
+
+private:
+    const AccountManager *mManager;
+};
+
 AccountManager::AccountManager()
 {
     mNetworkType = 0;
+    mUpdateDepth = 0;
+    mIsChanged = false;
+    mIsWriteScheduled = false;
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (!QFileInfo(dataPath).exists())
+    {
+        QDir().mkpath(dataPath);
+    }
+    mFilePath = QDir(dataPath).filePath(scAccountDataFile);
+    // A single writer thread keeps the writes in order.
+    mWriterPool.setMaxThreadCount(1);
     read();
 }
 
+AccountManager::~AccountManager()
+{
+    mWriterPool.waitForDone();
+}
+
 void AccountManager::setNetworkType(int network)
 {
     if (mNetworkType != network)
     {
         mNetworkType = network;
-        save();
+        changed();
     }
 }
 
@@ -33,7 +69,7 @@ void AccountManager::setPassword(const QString &passsword)
     if (mPassword != passsword)
     {
         mPassword = passsword;
-        save();
+        changed();
     }
 }
 
@@ -47,7 +83,7 @@ void AccountManager::setAccount(const QByteArray &data)
     if (mAccountData != data)
     {
         mAccountData = data;
-        save();
+        changed();
     }
 }
 
@@ -61,7 +97,7 @@ void AccountManager::setAddress(const QString &a)
     if (mAddress != a)
     {
         mAddress = a;
-        save();
+        changed();
     }
 }
 
@@ -75,7 +111,7 @@ void AccountManager::setViewKey(const QString &key)
     if (mViewKey != key)
     {
         mViewKey = key;
-        save();
+        changed();
     }
 }
 
@@ -89,7 +125,7 @@ void AccountManager::setSeed(const QString &seed)
     if (mSeed != seed)
     {
         mSeed = seed;
-        save();
+        changed();
     }
 }
 
@@ -98,31 +134,82 @@ QString AccountManager::seed() const
     return mSeed;
 }
 
-void AccountManager::save() const
+void AccountManager::beginUpdate()
 {
-    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    if (!QFileInfo(dataPath).exists())
+    ++mUpdateDepth;
+}
+
+void AccountManager::endUpdate()
+{
+    Q_ASSERT(mUpdateDepth > 0);
+    if (--mUpdateDepth == 0 && mIsChanged)
     {
-        QDir().mkpath(dataPath);
+        save();
     }
-    QDir lDir(dataPath);
-    QFile lFile(lDir.filePath(scAccountDataFile));
-    if (lFile.open(QFile::WriteOnly))
+}
+
+void AccountManager::save() const
+{
+    QByteArray data;
+    QDataStream in(&data, QIODevice::WriteOnly);
+    in << mPassword << mAccountData << mAddress << mSeed << mViewKey << mNetworkType;
+    mIsChanged = false;
+
+    QMutexLocker locker(&mWriteMutex);
+    mPendingData = data;
+    if (!mIsWriteScheduled)
     {
-        QDataStream in(&lFile);
-        in << mPassword << mAccountData << mAddress << mSeed << mViewKey << mNetworkType;
+        mIsWriteScheduled = true;
+        mWriterPool.start(new Writer(this));
     }
 }
 
 void AccountManager::clearData()
 {
+    beginUpdate();
     mAccountData.clear();
     mPassword.clear();
     mViewKey.clear();
     mAddress.clear();
     mNetworkType = 0;
     mSeed.clear();
-    save();
+    changed();
+    endUpdate();
+}
+
+void AccountManager::changed()
+{
+    mIsChanged = true;
+    if (mUpdateDepth == 0)
+    {
+        save();
+    }
+}
+
+void AccountManager::writePending() const
+{
+    // Snapshots saved while a write is running replace each other, only the latest one is
+    // written after it. QSaveFile replaces account.dat only once the whole snapshot is on disk.
+    forever
+    {
+        QByteArray data;
+        {
+            QMutexLocker locker(&mWriteMutex);
+            if (mPendingData.isNull())
+            {
+                mIsWriteScheduled = false;
+                return;
+            }
+            data = mPendingData;
+            mPendingData = QByteArray();
+        }
+        QSaveFile lFile(mFilePath);
+        if (lFile.open(QIODevice::WriteOnly))
+        {
+            lFile.write(data);
+            lFile.commit();
+        }
+    }
 }
 
 void AccountManager::read()
@@ -1,12 +1,15 @@
 #ifndef ACCOUNTMANAGER_H
 #define ACCOUNTMANAGER_H
 
+#include <QThreadPool>
 #include <QString>
+#include <QMutex>
 
 class AccountManager
 {
 public:
     AccountManager();
+    ~AccountManager();
 
     void setNetworkType(int network);
     int networkType() const;
@@ -26,11 +29,18 @@ public:
     void setSeed(const QString &seed);
     QString seed() const;
 
+    void beginUpdate();
+    void endUpdate();
+
     void save() const;
     void clearData();
 
 private:
+    class Writer;
+
     void read();
+    void changed();
+    void writePending() const;
 
     QString mPassword;
     QByteArray mAccountData;
@@ -38,6 +48,14 @@ private:
     QString mViewKey;
     QString mSeed;
     int mNetworkType;
+    int mUpdateDepth;
+    mutable bool mIsChanged;
+
+    QString mFilePath;
+    mutable QThreadPool mWriterPool;
+    mutable QMutex mWriteMutex;
+    mutable QByteArray mPendingData;
+    mutable bool mIsWriteScheduled;
 };
 
 #endif // ACCOUNTMANAGER_H
@@ -0,0 +1,81 @@
+#include "graftapithread.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QEvent>
+
+namespace {
+const QEvent::Type scInvokeEvent = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+class InvokeEvent : public QEvent
+{
+public:
+    explicit InvokeEvent(const std::function<void()> &call)
+        : QEvent(scInvokeEvent)
+        ,mCall(call)
+    {
+    }
+
+    void invoke() const
+    {
+        mCall();
+    }
+
+private:
+    std::function<void()> mCall;
+};
+
+class Invoker : public QObject
+{
+public:
+    bool event(QEvent *event) override
+    {
+        if (event->type() == scInvokeEvent)
+        {
+            static_cast<InvokeEvent *>(event)->invoke();
+            return true;
+        }
+        return QObject::event(event);
+    }
+};
+}
+
+GraftAPIThread::GraftAPIThread(QObject *parent)
+    : QObject(parent)
+{
+    mThread = new QThread(this);
+    mThread->setObjectName(QStringLiteral("GraftAPIThread"));
+    mInvoker = new Invoker();
+    attach(mInvoker);
+    mThread->start();
+}
+
+GraftAPIThread::~GraftAPIThread()
+{
+    stop();
+}
+
+void GraftAPIThread::attach(QObject *object)
+{
+    Q_ASSERT(object && !object->parent());
+    object->moveToThread(mThread);
+    connect(mThread, &QThread::finished, object, &QObject::deleteLater);
+}
+
+void GraftAPIThread::stop()
+{
+    // Attached objects are deleted on the worker thread before it finishes.
+    mThread->quit();
+    mThread->wait();
+}
+
+void GraftAPIThread::invoke(const std::function<void()> &call) const
+{
+    // Calls are queued to the worker thread in the order they are made, so a request
+    // issued after setUrl() or setAccountData() always sees the new values.
+    QCoreApplication::postEvent(mInvoker, new InvokeEvent(call));
+}
+
+bool GraftAPIThread::isCurrentThread() const
+{
+    return QThread::currentThread() == mThread;
+}
@@ -0,0 +1,26 @@
+#ifndef GRAFTAPITHREAD_H
+#define GRAFTAPITHREAD_H
+
+#include <functional>
+#include <QObject>
+
+class QThread;
+
+class GraftAPIThread : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GraftAPIThread(QObject *parent = nullptr);
+    ~GraftAPIThread();
+
+    void attach(QObject *object);
+    void stop();
+    void invoke(const std::function<void()> &call) const;
+    bool isCurrentThread() const;
+
+private:
+    QThread *mThread;
+    QObject *mInvoker;
+};
+
+#endif // GRAFTAPITHREAD_H
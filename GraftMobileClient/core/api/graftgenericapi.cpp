@@ -1,11 +1,21 @@
 #include "graftgenericapi.h"
+#include "jsonresultreader.h"
+#include "jsonrpcwriter.h"
+#include "requeststatistics.h"
+#include "supernodepool.h"
+#include "../logger.h"
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QTimer>
+
+static const int scRequestTimeout = 15000;
 
 GraftGenericAPI::GraftGenericAPI(const QUrl &url, const QString &dapiVersion, QObject *parent)
     : QObject(parent)
+    ,mSupernodePool(nullptr)
+    ,mStatistics(nullptr)
     ,mDAPIVersion(dapiVersion)
 {
     mManager = new QNetworkAccessManager(this);
@@ -27,6 +37,16 @@ void GraftGenericAPI::setDAPIVersion(const QString &version)
     mDAPIVersion = version;
 }
 
+void GraftGenericAPI::setSupernodePool(SupernodePool *pool)
+{
+    mSupernodePool = pool;
+}
+
+void GraftGenericAPI::setStatistics(RequestStatistics *statistics)
+{
+    mStatistics = statistics;
+}
+
 void GraftGenericAPI::setAccountData(const QByteArray &accountData, const QString &password)
 {
     mAccountData = accountData;
@@ -46,66 +66,51 @@ QString GraftGenericAPI::password() const
 void GraftGenericAPI::createAccount(const QString &password)
 {
     mPassword = password;
-    QJsonObject params;
-    params.insert(QStringLiteral("Password"), mPassword);
-    params.insert(QStringLiteral("Language"), QStringLiteral("English"));
-    QJsonObject data = buildMessage(QStringLiteral("CreateAccount"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftGenericAPI::receiveCreateAccountResponse);
+    JsonRpcWriter writer(DAPIMethods::CreateAccount, mDAPIVersion);
+    writer.addString("Password", mPassword)
+          .addString("Language", QStringLiteral("English"));
+    post(DAPIMethods::CreateAccount, writer.finish(),
+         &GraftGenericAPI::receiveCreateAccountResponse);
 }
 
 void GraftGenericAPI::getBalance()
 {
     if (mAccountData.isEmpty())
     {
-        qDebug() << "GraftGenericAPI: Account Data is empty.";
+        qCWarning(lcApi) << "Account Data is empty.";
         emit error(QStringLiteral("Couldn't find account data."));
         return;
     }
-    QJsonObject params;
-    params.insert(QStringLiteral("Password"), mPassword);
-    params.insert(QStringLiteral("Account"), accountPlaceholder());
-    QJsonObject data = buildMessage(QStringLiteral("GetWalletBalance"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    array.replace(accountPlaceholder(), mAccountData);
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftGenericAPI::receiveGetBalanceResponse);
+    JsonRpcWriter writer(DAPIMethods::GetWalletBalance, mDAPIVersion, mAccountData.size());
+    writer.addString("Password", mPassword)
+          .addRawString("Account", mAccountData);
+    post(DAPIMethods::GetWalletBalance, writer.finish(),
+         &GraftGenericAPI::receiveGetBalanceResponse);
 }
 
 void GraftGenericAPI::getSeed()
 {
     if (mAccountData.isEmpty())
     {
-        qDebug() << "GraftGenericAPI: Account Data is empty.";
+        qCWarning(lcApi) << "Account Data is empty.";
         emit error(QStringLiteral("Couldn't find account data."));
         return;
     }
-    QJsonObject params;
-    params.insert(QStringLiteral("Password"), mPassword);
-    params.insert(QStringLiteral("Account"), accountPlaceholder());
-    params.insert(QStringLiteral("Language"), QStringLiteral("English"));
-    QJsonObject data = buildMessage(QStringLiteral("GetSeed"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    array.replace(accountPlaceholder(), mAccountData);
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftGenericAPI::receiveGetSeedResponse);
+    JsonRpcWriter writer(DAPIMethods::GetSeed, mDAPIVersion, mAccountData.size());
+    writer.addString("Password", mPassword)
+          .addRawString("Account", mAccountData)
+          .addString("Language", QStringLiteral("English"));
+    post(DAPIMethods::GetSeed, writer.finish(), &GraftGenericAPI::receiveGetSeedResponse);
 }
 
 void GraftGenericAPI::restoreAccount(const QString &seed, const QString &password)
 {
     mPassword = password;
-    QJsonObject params;
-    params.insert(QStringLiteral("Password"), password);
-    params.insert(QStringLiteral("Seed"), seed);
-    QJsonObject data = buildMessage(QStringLiteral("RestoreAccount"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftGenericAPI::receiveRestoreAccountResponse);
+    JsonRpcWriter writer(DAPIMethods::RestoreAccount, mDAPIVersion);
+    writer.addString("Password", password)
+          .addString("Seed", seed);
+    post(DAPIMethods::RestoreAccount, writer.finish(),
+         &GraftGenericAPI::receiveRestoreAccountResponse);
 }
 
 double GraftGenericAPI::toCoins(double atomic)
@@ -118,11 +123,6 @@ double GraftGenericAPI::toAtomic(double coins)
     return coins * 10000000000;
 }
 
-QString GraftGenericAPI::accountPlaceholder() const
-{
-    return QString("????");
-}
-
 QByteArray GraftGenericAPI::serializeAmount(double amount) const
 {
     QByteArray serializedAmount;
@@ -130,31 +130,15 @@ QByteArray GraftGenericAPI::serializeAmount(double amount) const
     return serializedAmount;
 }
 
-QJsonObject GraftGenericAPI::buildMessage(const QString &key, const QJsonObject &params) const
-{
-    QJsonObject data;
-    data.insert(QStringLiteral("jsonrpc"), QStringLiteral("2.0"));
-    data.insert(QStringLiteral("id"), QStringLiteral("0"));
-    data.insert(QStringLiteral("method"), key);
-    data.insert(QStringLiteral("dapi_version"), mDAPIVersion);
-    if (!params.isEmpty())
-    {
-        data.insert(QStringLiteral("params"), params);
-    }
-    return data;
-}
-
 QJsonObject GraftGenericAPI::processReply(QNetworkReply *reply)
 {
     QJsonObject object;
     if (reply->error() == QNetworkReply::NoError)
     {
         QByteArray rawData = reply->readAll();
-        qDebug() << rawData;
         if (!rawData.isEmpty())
         {
             QJsonObject response = QJsonDocument::fromJson(rawData).object();
-            qDebug() << response.toVariantMap();
             if (response.contains(QLatin1String("result")))
             {
                 object = response.value(QLatin1String("result")).toObject();
@@ -178,10 +162,124 @@ QJsonObject GraftGenericAPI::processReply(QNetworkReply *reply)
     return object;
 }
 
-void GraftGenericAPI::receiveCreateAccountResponse()
+void GraftGenericAPI::receiveReply()
 {
-    qDebug() << "CreateAccount Response Received:\nTime: " << mTimer.elapsed();
     QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply || !mRequests.contains(reply))
+    {
+        return;
+    }
+    RequestContext context = mRequests.take(reply);
+    mRequestRegistry.remove(context.data);
+    context.bytesIn += reply->bytesAvailable();
+    if (mSupernodePool && context.node.isValid())
+    {
+        if (SupernodePool::isTransportError(reply->error()))
+        {
+            mSupernodePool->reportFailure(context.node);
+            // A dropped connection or a timeout may come after the node has already executed
+            // the request, only requests that are safe to repeat are sent to the next node then.
+            if ((context.isIdempotent || SupernodePool::isConnectionError(reply->error()))
+                    && context.triedNodes.count() < mSupernodePool->count())
+            {
+                qCInfo(lcApi) << context.method << "request to" << context.node.toString()
+                              << "failed with" << reply->errorString()
+                              << "- trying next supernode.";
+                reply->deleteLater();
+                reply = nullptr;
+                dispatchRequest(context);
+                return;
+            }
+        }
+        else
+        {
+            mSupernodePool->reportSuccess(context.node, context.attemptStarted.elapsed());
+        }
+    }
+    finishRequest(context, reply);
+    (this->*context.handler)(reply);
+}
+
+void GraftGenericAPI::sendRequest(const DAPIMethod &method, const QByteArray &data,
+                                  ReplyHandler handler)
+{
+    // The request body holds both the method and all of its parameters, so identical
+    // requests are found by the body itself. QByteArray is implicitly shared, the registry
+    // doesn't copy it.
+    QNetworkReply *inFlight = mRequestRegistry.value(data);
+    if (inFlight && mRequests.contains(inFlight))
+    {
+        RequestContext &pending = mRequests[inFlight];
+        if (method.isIdempotent)
+        {
+            ++pending.callers;
+            qCDebug(lcApi) << pending.method
+                           << "request is coalesced with the one in flight, callers:"
+                           << pending.callers;
+        }
+        else
+        {
+            qCInfo(lcApi) << "Duplicate" << pending.method
+                          << "request is rejected while the first one is in flight.";
+            emit error(QStringLiteral("%1 request is already pending.").arg(pending.method));
+        }
+        return;
+    }
+    RequestContext context;
+    context.method = QString::fromLatin1(method.name);
+    context.data = data;
+    context.handler = handler;
+    context.isIdempotent = method.isIdempotent;
+    context.bytesOut = 0;
+    context.bytesIn = 0;
+    context.callers = 1;
+    context.started.start();
+    dispatchRequest(context);
+}
+
+void GraftGenericAPI::dispatchRequest(RequestContext context)
+{
+    QNetworkRequest networkRequest(mRequest);
+    context.node = mRequest.url();
+    if (mSupernodePool)
+    {
+        QUrl url = mSupernodePool->bestUrl(context.triedNodes);
+        if (url.isValid())
+        {
+            context.node = url;
+            networkRequest.setUrl(url);
+            context.triedNodes.append(url);
+        }
+    }
+    context.bytesOut += context.data.size();
+    // Bodies carry accounts and passwords, only their size is logged.
+    qCDebug(lcApi) << context.method << "request to" << context.node.host() << "with"
+                   << context.data.size() << "bytes";
+    context.attemptStarted.start();
+    QNetworkReply *reply = mManager->post(networkRequest, context.data);
+    mRequests.insert(reply, context);
+    mRequestRegistry.insert(context.data, reply);
+    connect(reply, &QNetworkReply::finished, this, &GraftGenericAPI::receiveReply);
+    // A node that silently drops the traffic would never answer, the abort turns that into an
+    // OperationCanceledError that is handled like any other transport error.
+    QTimer::singleShot(scRequestTimeout, reply, &QNetworkReply::abort);
+}
+
+void GraftGenericAPI::finishRequest(const RequestContext &context, QNetworkReply *reply)
+{
+    const qint64 latency = context.started.elapsed();
+    qCDebug(lcApi) << context.method << "Response Received:\nTime: " << latency
+                   << "Node:" << context.node.toString() << "Sent:" << context.bytesOut
+                   << "Received:" << context.bytesIn << "Callers:" << context.callers;
+    if (mStatistics)
+    {
+        mStatistics->record(context.method, latency, context.bytesOut, context.bytesIn,
+                            reply->error() == QNetworkReply::NoError);
+    }
+}
+
+void GraftGenericAPI::receiveCreateAccountResponse(QNetworkReply *reply)
+{
     if (reply->error() != QNetworkReply::NoError)
     {
         emit error(reply->errorString());
@@ -190,50 +288,32 @@ void GraftGenericAPI::receiveCreateAccountResponse()
         emit createAccountReceived(mAccountData, mPassword, "", "", "");
         return;
     }
-    QByteArray arr = reply->readAll();
+    JsonResultReader response(reply->readAll());
     reply->deleteLater();
     reply = nullptr;
-    QByteArray temp("\"Account\": \"");
-    int index = arr.indexOf(temp);
-    int end = arr.indexOf("\",\r\n    \"Address\":");
-    QByteArray accountArr;
-    for (int i = index + temp.size(); i < end; ++i)
-    {
-        accountArr.append(arr.at(i));
-    }
-    arr.remove(index + temp.size(), end - (index + temp.size()));
-    QString address;
-    QString viewKey;
-    QString seed;
-    QJsonObject response = QJsonDocument::fromJson(arr).object();
-    if (response.contains(QLatin1String("result")))
-    {
-        QJsonObject object = response.value(QLatin1String("result")).toObject();
-        address = object.value(QLatin1String("Address")).toString();
-        seed = object.value(QLatin1String("Seed")).toString();
-        viewKey = object.value(QLatin1String("ViewKey")).toString();
-    }
-    else
+    if (!response.hasResult())
     {
         emit error(QStringLiteral("Response error"));
         emit createAccountReceived(mAccountData, mPassword, "", "", "");
         return;
     }
-    if (accountArr.isEmpty() || address.isEmpty())
+    QByteArray accountData = response.rawValue("Account");
+    QString address = response.string("Address");
+    QString viewKey = response.string("ViewKey");
+    QString seed = response.string("Seed");
+    if (accountData.isEmpty() || address.isEmpty())
     {
         emit error(QStringLiteral("Couldn't get account data!"));
         emit createAccountReceived(mAccountData, mPassword, "", "", "");
         return;
     }
-    mAccountData = accountArr;
-    qDebug() << mAccountData << address << viewKey << seed;
+    mAccountData = accountData;
+    qCDebug(lcApi) << "Account received for" << address;
     emit createAccountReceived(mAccountData, mPassword, address, viewKey, seed);
 }
 
-void GraftGenericAPI::receiveGetBalanceResponse()
+void GraftGenericAPI::receiveGetBalanceResponse(QNetworkReply *reply)
 {
-    qDebug() << "GetBalance Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
@@ -242,10 +322,8 @@ void GraftGenericAPI::receiveGetBalanceResponse()
     }
 }
 
-void GraftGenericAPI::receiveGetSeedResponse()
+void GraftGenericAPI::receiveGetSeedResponse(QNetworkReply *reply)
 {
-    qDebug() << "GetSeed Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
@@ -253,10 +331,8 @@ void GraftGenericAPI::receiveGetSeedResponse()
     }
 }
 
-void GraftGenericAPI::receiveRestoreAccountResponse()
+void GraftGenericAPI::receiveRestoreAccountResponse(QNetworkReply *reply)
 {
-    qDebug() << "RestoreAccount Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     if (reply->error() != QNetworkReply::NoError)
     {
         emit error(reply->errorString());
@@ -265,42 +341,26 @@ void GraftGenericAPI::receiveRestoreAccountResponse()
         emit restoreAccountReceived(mAccountData, mPassword, "", "", "");
         return;
     }
-    QByteArray arr = reply->readAll();
+    JsonResultReader response(reply->readAll());
     reply->deleteLater();
     reply = nullptr;
-    QByteArray temp("\"Account\": \"");
-    int index = arr.indexOf(temp);
-    int end = arr.indexOf("\",\r\n    \"Address\":");
-    QByteArray accountArr;
-    for (int i = index + temp.size(); i < end; ++i)
-    {
-        accountArr.append(arr.at(i));
-    }
-    arr.remove(index + temp.size(), end - (index + temp.size()));
-    QString address;
-    QString viewKey;
-    QString seed;
-    QJsonObject response = QJsonDocument::fromJson(arr).object();
-    if (response.contains(QLatin1String("result")))
-    {
-        QJsonObject object = response.value(QLatin1String("result")).toObject();
-        address = object.value(QLatin1String("Address")).toString();
-        seed = object.value(QLatin1String("Seed")).toString();
-        viewKey = object.value(QLatin1String("ViewKey")).toString();
-    }
-    else
+    if (!response.hasResult())
     {
         emit error(QStringLiteral("Response error"));
         emit restoreAccountReceived(mAccountData, mPassword, "", "", "");
         return;
     }
-    if (accountArr.isEmpty() || address.isEmpty())
+    QByteArray accountData = response.rawValue("Account");
+    QString address = response.string("Address");
+    QString viewKey = response.string("ViewKey");
+    QString seed = response.string("Seed");
+    if (accountData.isEmpty() || address.isEmpty())
     {
         emit error(QStringLiteral("Couldn't restore account data!"));
         emit restoreAccountReceived(mAccountData, mPassword, "", "", "");
         return;
     }
-    mAccountData = accountArr;
-    qDebug() << mAccountData << address << viewKey << seed;
+    mAccountData = accountData;
+    qCDebug(lcApi) << "Account received for" << address;
     emit restoreAccountReceived(mAccountData, mPassword, address, viewKey, seed);
 }
@@ -5,9 +5,14 @@
 #include <QElapsedTimer>
 #include <QJsonObject>
 #include <QObject>
+#include <QHash>
+#include <QUrl>
 
 class QNetworkAccessManager;
 class QNetworkReply;
+class RequestStatistics;
+class SupernodePool;
+struct DAPIMethod;
 
 class GraftGenericAPI : public QObject
 {
@@ -29,6 +34,8 @@ public:
 
     void setUrl(const QUrl &url);
     void setDAPIVersion(const QString &version);
+    void setSupernodePool(SupernodePool *pool);
+    void setStatistics(RequestStatistics *statistics);
 
     void setAccountData(const QByteArray &accountData, const QString &password);
     QByteArray accountData() const;
@@ -54,26 +61,60 @@ signals:
     void test(int v);
 
 protected:
-    QString accountPlaceholder() const;
+    typedef void (GraftGenericAPI::*ReplyHandler)(QNetworkReply *reply);
+
+    template <typename Api>
+    void post(const DAPIMethod &method, const QByteArray &data,
+              void (Api::*handler)(QNetworkReply *))
+    {
+        sendRequest(method, data, static_cast<ReplyHandler>(handler));
+    }
+
     QByteArray serializeAmount(double amount) const;
-    QJsonObject buildMessage(const QString &key, const QJsonObject &params = QJsonObject()) const;
     QJsonObject processReply(QNetworkReply *reply);
 
 private slots:
-    void receiveCreateAccountResponse();
-    void receiveGetBalanceResponse();
-    void receiveGetSeedResponse();
-    void receiveRestoreAccountResponse();
+    void receiveReply();
+
+private:
+    struct RequestContext
+    {
+        QString method;
+        QByteArray data;
+        ReplyHandler handler;
+        QUrl node;
+        QList<QUrl> triedNodes;
+        QElapsedTimer started;
+        QElapsedTimer attemptStarted;
+        bool isIdempotent;
+        qint64 bytesOut;
+        qint64 bytesIn;
+        int callers;
+    };
+
+    void sendRequest(const DAPIMethod &method, const QByteArray &data, ReplyHandler handler);
+    void dispatchRequest(RequestContext context);
+    void finishRequest(const RequestContext &context, QNetworkReply *reply);
+
+    void receiveCreateAccountResponse(QNetworkReply *reply);
+    void receiveGetBalanceResponse(QNetworkReply *reply);
+    void receiveGetSeedResponse(QNetworkReply *reply);
+    void receiveRestoreAccountResponse(QNetworkReply *reply);
 
 protected:
     QNetworkAccessManager *mManager;
     QNetworkRequest mRequest;
-    QElapsedTimer mTimer;
+    SupernodePool *mSupernodePool;
+    RequestStatistics *mStatistics;
 
     QByteArray mAccountData;
     QString mPassword;
 
     QString mDAPIVersion;
+
+private:
+    QHash<QNetworkReply *, RequestContext> mRequests;
+    QHash<QByteArray, QNetworkReply *> mRequestRegistry;
 };
 
 #endif // GRAFTGENERICAPI_H
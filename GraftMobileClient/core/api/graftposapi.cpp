@@ -1,9 +1,7 @@
 #include "graftposapi.h"
-#include <QNetworkAccessManager>
+#include "jsonrpcwriter.h"
 #include <QNetworkReply>
-#include <QJsonDocument>
 #include <QJsonObject>
-#include <QDebug>
 
 GraftPOSAPI::GraftPOSAPI(const QUrl &url, const QString &dapiVersion, QObject *parent)
     : GraftGenericAPI(url, dapiVersion, parent)
@@ -13,46 +11,30 @@ GraftPOSAPI::GraftPOSAPI(const QUrl &url, const QString &dapiVersion, QObject *p
 void GraftPOSAPI::sale(const QString &address, const QString &viewKey, double amount,
                        const QString &saleDetails)
 {
-    QJsonObject params;
-    params.insert(QStringLiteral("POSAddress"), address);
-    params.insert(QStringLiteral("POSViewKey"), viewKey);
-    params.insert(QStringLiteral("POSSaleDetails"), saleDetails);
-    params.insert(QStringLiteral("Amount"), -666);
-    QJsonObject data = buildMessage(QStringLiteral("Sale"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    array.replace("-666", serializeAmount(amount));
-    mTimer.start();
-    qDebug() << array;
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftPOSAPI::receiveSaleResponse);
+    JsonRpcWriter writer(DAPIMethods::Sale, mDAPIVersion, saleDetails.size());
+    writer.addString("POSAddress", address)
+          .addString("POSViewKey", viewKey)
+          .addString("POSSaleDetails", saleDetails)
+          .addRawNumber("Amount", serializeAmount(amount));
+    post(DAPIMethods::Sale, writer.finish(), &GraftPOSAPI::receiveSaleResponse);
 }
 
 void GraftPOSAPI::rejectSale(const QString &pid)
 {
-    QJsonObject params;
-    params.insert(QStringLiteral("PaymentID"), pid);
-    QJsonObject data = buildMessage(QStringLiteral("PosRejectSale"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftPOSAPI::receiveRejectSaleResponse);
+    JsonRpcWriter writer(DAPIMethods::PosRejectSale, mDAPIVersion);
+    writer.addString("PaymentID", pid);
+    post(DAPIMethods::PosRejectSale, writer.finish(), &GraftPOSAPI::receiveRejectSaleResponse);
 }
 
 void GraftPOSAPI::getSaleStatus(const QString &pid)
 {
-    QJsonObject params;
-    params.insert(QStringLiteral("PaymentID"), pid);
-    QJsonObject data = buildMessage(QStringLiteral("GetSaleStatus"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftPOSAPI::receiveSaleStatusResponse);
+    JsonRpcWriter writer(DAPIMethods::GetSaleStatus, mDAPIVersion);
+    writer.addString("PaymentID", pid);
+    post(DAPIMethods::GetSaleStatus, writer.finish(), &GraftPOSAPI::receiveSaleStatusResponse);
 }
 
-void GraftPOSAPI::receiveSaleResponse()
+void GraftPOSAPI::receiveSaleResponse(QNetworkReply *reply)
 {
-    qDebug() << "Sale Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
@@ -62,10 +44,8 @@ void GraftPOSAPI::receiveSaleResponse()
     }
 }
 
-void GraftPOSAPI::receiveRejectSaleResponse()
+void GraftPOSAPI::receiveRejectSaleResponse(QNetworkReply *reply)
 {
-    qDebug() << "RejectSale Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
@@ -73,14 +53,16 @@ void GraftPOSAPI::receiveRejectSaleResponse()
     }
 }
 
-void GraftPOSAPI::receiveSaleStatusResponse()
+void GraftPOSAPI::receiveSaleStatusResponse(QNetworkReply *reply)
 {
-    qDebug() << "GetSaleStatus Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
         emit getSaleStatusResponseReceived(object.value(QLatin1String("Result")).toInt(),
                                            object.value(QLatin1String("Status")).toInt());
     }
+    else
+    {
+        emit getSaleStatusFailed();
+    }
 }
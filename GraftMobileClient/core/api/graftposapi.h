@@ -18,11 +18,12 @@ signals:
     void saleResponseReceived(int result, const QString &pid, int blockNum);
     void rejectSaleResponseReceived(int result);
     void getSaleStatusResponseReceived(int result, int status);
+    void getSaleStatusFailed();
 
-private slots:
-    void receiveSaleResponse();
-    void receiveRejectSaleResponse();
-    void receiveSaleStatusResponse();
+private:
+    void receiveSaleResponse(QNetworkReply *reply);
+    void receiveRejectSaleResponse(QNetworkReply *reply);
+    void receiveSaleStatusResponse(QNetworkReply *reply);
 };
 
 #endif // GRAFTPOSAPI_H
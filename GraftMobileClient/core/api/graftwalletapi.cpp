@@ -1,9 +1,7 @@
 #include "graftwalletapi.h"
-#include <QNetworkAccessManager>
+#include "jsonrpcwriter.h"
 #include <QNetworkReply>
-#include <QJsonDocument>
 #include <QJsonObject>
-#include <QDebug>
 
 GraftWalletAPI::GraftWalletAPI(const QUrl &url, const QString &dapiVersion, QObject *parent)
     : GraftGenericAPI(url, dapiVersion, parent)
@@ -12,62 +10,43 @@ GraftWalletAPI::GraftWalletAPI(const QUrl &url, const QString &dapiVersion, QObj
 
 void GraftWalletAPI::getPOSData(const QString &pid, int blockNum)
 {
-    QJsonObject params;
-    params.insert(QStringLiteral("PaymentID"), pid);
-    params.insert(QStringLiteral("BlockNum"), blockNum);
-    QJsonObject data = buildMessage(QStringLiteral("WalletGetPosData"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftWalletAPI::receiveGetPOSDataResponse);
+    JsonRpcWriter writer(DAPIMethods::WalletGetPosData, mDAPIVersion);
+    writer.addString("PaymentID", pid)
+          .addNumber("BlockNum", blockNum);
+    post(DAPIMethods::WalletGetPosData, writer.finish(),
+         &GraftWalletAPI::receiveGetPOSDataResponse);
 }
 
 void GraftWalletAPI::rejectPay(const QString &pid, int blockNum)
 {
-    QJsonObject params;
-    params.insert(QStringLiteral("PaymentID"), pid);
-    params.insert(QStringLiteral("BlockNum"), blockNum);
-    QJsonObject data = buildMessage(QStringLiteral("WalletRejectPay"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftWalletAPI::receiveRejectPayResponse);
+    JsonRpcWriter writer(DAPIMethods::WalletRejectPay, mDAPIVersion);
+    writer.addString("PaymentID", pid)
+          .addNumber("BlockNum", blockNum);
+    post(DAPIMethods::WalletRejectPay, writer.finish(),
+         &GraftWalletAPI::receiveRejectPayResponse);
 }
 
 void GraftWalletAPI::pay(const QString &pid, const QString &address, double amount, int blockNum)
 {
-    QJsonObject params;
-    params.insert(QStringLiteral("Account"), accountPlaceholder());
-    params.insert(QStringLiteral("Password"), mPassword);
-    params.insert(QStringLiteral("PaymentID"), pid);
-    params.insert(QStringLiteral("POSAddress"), address);
-    params.insert(QStringLiteral("Amount"), -666);
-    params.insert(QStringLiteral("BlockNum"), blockNum);
-    QJsonObject data = buildMessage(QStringLiteral("Pay"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    array.replace("????", mAccountData);
-    array.replace("-666", serializeAmount(amount));
-    qDebug() << array;
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftWalletAPI::receivePayResponse);
+    JsonRpcWriter writer(DAPIMethods::Pay, mDAPIVersion, mAccountData.size());
+    writer.addRawString("Account", mAccountData)
+          .addString("Password", mPassword)
+          .addString("PaymentID", pid)
+          .addString("POSAddress", address)
+          .addRawNumber("Amount", serializeAmount(amount))
+          .addNumber("BlockNum", blockNum);
+    post(DAPIMethods::Pay, writer.finish(), &GraftWalletAPI::receivePayResponse);
 }
 
 void GraftWalletAPI::getPayStatus(const QString &pid)
 {
-    QJsonObject params;
-    params.insert(QStringLiteral("PaymentID"), pid);
-    QJsonObject data = buildMessage(QStringLiteral("GetPayStatus"), params);
-    QByteArray array = QJsonDocument(data).toJson();
-    mTimer.start();
-    QNetworkReply *reply = mManager->post(mRequest, array);
-    connect(reply, &QNetworkReply::finished, this, &GraftWalletAPI::receivePayStatusResponse);
+    JsonRpcWriter writer(DAPIMethods::GetPayStatus, mDAPIVersion);
+    writer.addString("PaymentID", pid);
+    post(DAPIMethods::GetPayStatus, writer.finish(), &GraftWalletAPI::receivePayStatusResponse);
 }
 
-void GraftWalletAPI::receiveGetPOSDataResponse()
+void GraftWalletAPI::receiveGetPOSDataResponse(QNetworkReply *reply)
 {
-    qDebug() << "GetPOSData Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
@@ -76,10 +55,8 @@ void GraftWalletAPI::receiveGetPOSDataResponse()
     }
 }
 
-void GraftWalletAPI::receiveRejectPayResponse()
+void GraftWalletAPI::receiveRejectPayResponse(QNetworkReply *reply)
 {
-    qDebug() << "RejectPay Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
@@ -87,10 +64,8 @@ void GraftWalletAPI::receiveRejectPayResponse()
     }
 }
 
-void GraftWalletAPI::receivePayResponse()
+void GraftWalletAPI::receivePayResponse(QNetworkReply *reply)
 {
-    qDebug() << "Pay Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
@@ -98,14 +73,16 @@ void GraftWalletAPI::receivePayResponse()
     }
 }
 
-void GraftWalletAPI::receivePayStatusResponse()
+void GraftWalletAPI::receivePayStatusResponse(QNetworkReply *reply)
 {
-    qDebug() << "GetPayStatus Response Received:\nTime: " << mTimer.elapsed();
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
     QJsonObject object = processReply(reply);
     if (!object.isEmpty())
     {
         emit getPayStatusReceived(object.value(QLatin1String("Result")).toInt(),
                                   object.value(QLatin1String("Status")).toInt());
     }
+    else
+    {
+        emit getPayStatusFailed();
+    }
 }
@@ -19,12 +19,13 @@ signals:
     void rejectPayReceived(int result);
     void payReceived(int result);
     void getPayStatusReceived(int result, int status);
+    void getPayStatusFailed();
 
-private slots:
-    void receiveGetPOSDataResponse();
-    void receiveRejectPayResponse();
-    void receivePayResponse();
-    void receivePayStatusResponse();
+private:
+    void receiveGetPOSDataResponse(QNetworkReply *reply);
+    void receiveRejectPayResponse(QNetworkReply *reply);
+    void receivePayResponse(QNetworkReply *reply);
+    void receivePayStatusResponse(QNetworkReply *reply);
 };
 
 #endif // GRAFTWALLETAPI_H
@@ -0,0 +1,327 @@
+#include "jsonresultreader.h"
+#include <cstring>
+
+static const int scMaxDepth = 64;
+
+JsonResultReader::JsonResultReader(const QByteArray &data)
+    : mData(data)
+    ,mBegin(mData.constData())
+    ,mCurrent(mBegin)
+    ,mEnd(mBegin + mData.size())
+    ,mIsValid(false)
+    ,mHasResult(false)
+    ,mHasError(false)
+{
+    skipWhitespace();
+    if (mCurrent < mEnd && *mCurrent == '{')
+    {
+        mIsValid = parseObject(0, false);
+        skipWhitespace();
+        mIsValid = mIsValid && mCurrent == mEnd;
+    }
+}
+
+bool JsonResultReader::isValid() const
+{
+    return mIsValid;
+}
+
+bool JsonResultReader::hasResult() const
+{
+    return mIsValid && mHasResult;
+}
+
+bool JsonResultReader::hasError() const
+{
+    return mHasError;
+}
+
+bool JsonResultReader::contains(const QByteArray &key) const
+{
+    return mResult.contains(key);
+}
+
+QByteArray JsonResultReader::rawValue(const QByteArray &key) const
+{
+    if (!mResult.contains(key))
+    {
+        return QByteArray();
+    }
+    const Slice slice = mResult.value(key);
+    return mData.mid(slice.offset, slice.size);
+}
+
+QString JsonResultReader::string(const QByteArray &key) const
+{
+    if (!mResult.contains(key))
+    {
+        return QString();
+    }
+    const Slice slice = mResult.value(key);
+    if (slice.isString)
+    {
+        return unescape(mBegin + slice.offset, slice.size);
+    }
+    return QString::fromUtf8(mBegin + slice.offset, slice.size);
+}
+
+int JsonResultReader::toInt(const QByteArray &key, int defaultValue) const
+{
+    if (!mResult.contains(key))
+    {
+        return defaultValue;
+    }
+    const Slice slice = mResult.value(key);
+    bool isOk = false;
+    const int value = QByteArray::fromRawData(mBegin + slice.offset, slice.size).toInt(&isOk);
+    return isOk ? value : defaultValue;
+}
+
+double JsonResultReader::toDouble(const QByteArray &key, double defaultValue) const
+{
+    if (!mResult.contains(key))
+    {
+        return defaultValue;
+    }
+    const Slice slice = mResult.value(key);
+    bool isOk = false;
+    const double value = QByteArray::fromRawData(mBegin + slice.offset,
+                                                 slice.size).toDouble(&isOk);
+    return isOk ? value : defaultValue;
+}
+
+QString JsonResultReader::unescape(const char *data, int size)
+{
+    if (!memchr(data, '\\', size))
+    {
+        return QString::fromUtf8(data, size);
+    }
+    QString value;
+    value.reserve(size);
+    int start = 0;
+    int i = 0;
+    while (i < size)
+    {
+        if (data[i] != '\\' || i + 1 >= size)
+        {
+            ++i;
+            continue;
+        }
+        value.append(QString::fromUtf8(data + start, i - start));
+        const char escaped = data[i + 1];
+        i += 2;
+        switch (escaped)
+        {
+        case 'b':
+            value.append(QLatin1Char('\b'));
+            break;
+        case 'f':
+            value.append(QLatin1Char('\f'));
+            break;
+        case 'n':
+            value.append(QLatin1Char('\n'));
+            break;
+        case 'r':
+            value.append(QLatin1Char('\r'));
+            break;
+        case 't':
+            value.append(QLatin1Char('\t'));
+            break;
+        case 'u':
+            if (i + 4 <= size)
+            {
+                bool isOk = false;
+                const ushort code = QByteArray::fromRawData(data + i, 4).toUShort(&isOk, 16);
+                if (isOk)
+                {
+                    value.append(QChar(code));
+                }
+                i += 4;
+            }
+            break;
+        default:
+            value.append(QLatin1Char(escaped));
+            break;
+        }
+        start = i;
+    }
+    value.append(QString::fromUtf8(data + start, size - start));
+    return value;
+}
+
+bool JsonResultReader::parseObject(int depth, bool isResult)
+{
+    if (depth > scMaxDepth)
+    {
+        return false;
+    }
+    ++mCurrent;
+    skipWhitespace();
+    if (mCurrent < mEnd && *mCurrent == '}')
+    {
+        ++mCurrent;
+        return true;
+    }
+    while (mCurrent < mEnd)
+    {
+        Slice key;
+        if (*mCurrent != '"' || !parseString(&key))
+        {
+            return false;
+        }
+        skipWhitespace();
+        if (mCurrent >= mEnd || *mCurrent != ':')
+        {
+            return false;
+        }
+        ++mCurrent;
+        skipWhitespace();
+        const QByteArray name = QByteArray::fromRawData(mBegin + key.offset, key.size);
+        Slice value;
+        if (depth == 0 && name == "result" && mCurrent < mEnd && *mCurrent == '{')
+        {
+            mHasResult = true;
+            if (!parseObject(depth + 1, true))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (depth == 0 && name == "error")
+            {
+                mHasError = true;
+            }
+            if (!parseValue(depth + 1, &value, false))
+            {
+                return false;
+            }
+            if (isResult)
+            {
+                mResult.insert(QByteArray(name.constData(), name.size()), value);
+            }
+        }
+        skipWhitespace();
+        if (mCurrent < mEnd && *mCurrent == ',')
+        {
+            ++mCurrent;
+            skipWhitespace();
+            continue;
+        }
+        if (mCurrent < mEnd && *mCurrent == '}')
+        {
+            ++mCurrent;
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+bool JsonResultReader::parseValue(int depth, Slice *slice, bool isResult)
+{
+    if (mCurrent >= mEnd || depth > scMaxDepth)
+    {
+        return false;
+    }
+    const char *start = mCurrent;
+    slice->isString = false;
+    switch (*mCurrent)
+    {
+    case '"':
+        return parseString(slice);
+    case '{':
+        if (!parseObject(depth, isResult))
+        {
+            return false;
+        }
+        break;
+    case '[':
+        ++mCurrent;
+        skipWhitespace();
+        if (mCurrent < mEnd && *mCurrent == ']')
+        {
+            ++mCurrent;
+            break;
+        }
+        while (true)
+        {
+            Slice item;
+            skipWhitespace();
+            if (!parseValue(depth + 1, &item, false))
+            {
+                return false;
+            }
+            skipWhitespace();
+            if (mCurrent < mEnd && *mCurrent == ',')
+            {
+                ++mCurrent;
+                continue;
+            }
+            if (mCurrent < mEnd && *mCurrent == ']')
+            {
+                ++mCurrent;
+                break;
+            }
+            return false;
+        }
+        break;
+    default:
+        if (!parseLiteral())
+        {
+            return false;
+        }
+        break;
+    }
+    slice->offset = static_cast<int>(start - mBegin);
+    slice->size = static_cast<int>(mCurrent - start);
+    return true;
+}
+
+bool JsonResultReader::parseString(Slice *slice)
+{
+    ++mCurrent;
+    const char *start = mCurrent;
+    while (mCurrent < mEnd)
+    {
+        const char c = *mCurrent;
+        if (c == '"')
+        {
+            slice->offset = static_cast<int>(start - mBegin);
+            slice->size = static_cast<int>(mCurrent - start);
+            slice->isString = true;
+            ++mCurrent;
+            return true;
+        }
+        if (c == '\\' && mCurrent + 1 >= mEnd)
+        {
+            return false;
+        }
+        mCurrent += (c == '\\') ? 2 : 1;
+    }
+    return false;
+}
+
+bool JsonResultReader::parseLiteral()
+{
+    const char *start = mCurrent;
+    while (mCurrent < mEnd)
+    {
+        const char c = *mCurrent;
+        if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            break;
+        }
+        ++mCurrent;
+    }
+    return mCurrent > start;
+}
+
+void JsonResultReader::skipWhitespace()
+{
+    while (mCurrent < mEnd
+           && (*mCurrent == ' ' || *mCurrent == '\t' || *mCurrent == '\r' || *mCurrent == '\n'))
+    {
+        ++mCurrent;
+    }
+}
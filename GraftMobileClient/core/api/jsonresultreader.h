@@ -0,0 +1,49 @@
+#ifndef JSONRESULTREADER_H
+#define JSONRESULTREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+
+class JsonResultReader
+{
+public:
+    explicit JsonResultReader(const QByteArray &data);
+
+    bool isValid() const;
+    bool hasResult() const;
+    bool hasError() const;
+
+    bool contains(const QByteArray &key) const;
+    QByteArray rawValue(const QByteArray &key) const;
+    QString string(const QByteArray &key) const;
+    int toInt(const QByteArray &key, int defaultValue = 0) const;
+    double toDouble(const QByteArray &key, double defaultValue = 0.0) const;
+
+    static QString unescape(const char *data, int size);
+
+private:
+    struct Slice
+    {
+        int offset;
+        int size;
+        bool isString;
+    };
+
+    bool parseObject(int depth, bool isResult);
+    bool parseValue(int depth, Slice *slice, bool isResult);
+    bool parseString(Slice *slice);
+    bool parseLiteral();
+    void skipWhitespace();
+
+    QByteArray mData;
+    const char *mBegin;
+    const char *mCurrent;
+    const char *mEnd;
+    QHash<QByteArray, Slice> mResult;
+    bool mIsValid;
+    bool mHasResult;
+    bool mHasError;
+};
+
+#endif // JSONRESULTREADER_H
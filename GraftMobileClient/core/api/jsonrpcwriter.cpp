@@ -0,0 +1,105 @@
+#include "jsonrpcwriter.h"
+
+static const int scEnvelopeSize = 96;
+static const char scHexDigits[] = "0123456789abcdef";
+
+JsonRpcWriter::JsonRpcWriter(const DAPIMethod &method, const QString &dapiVersion,
+                             int extraSize)
+    : mHasParams(false)
+{
+    mBuffer.reserve(scEnvelopeSize + method.paramsSize + extraSize);
+    mBuffer.append("{\"jsonrpc\":\"2.0\",\"id\":\"0\",\"method\":\"");
+    mBuffer.append(method.name);
+    mBuffer.append("\",\"dapi_version\":\"");
+    appendEscaped(mBuffer, dapiVersion.toUtf8());
+    mBuffer.append('"');
+}
+
+JsonRpcWriter &JsonRpcWriter::addString(const char *key, const QString &value)
+{
+    appendKey(key);
+    mBuffer.append('"');
+    appendEscaped(mBuffer, value.toUtf8());
+    mBuffer.append('"');
+    return *this;
+}
+
+JsonRpcWriter &JsonRpcWriter::addRawString(const char *key, const QByteArray &value)
+{
+    // The value is already a valid JSON string body (like the account blob returned by the
+    // supernode), so it is copied into the buffer as is, without scanning.
+    appendKey(key);
+    mBuffer.append('"');
+    mBuffer.append(value);
+    mBuffer.append('"');
+    return *this;
+}
+
+JsonRpcWriter &JsonRpcWriter::addNumber(const char *key, int value)
+{
+    appendKey(key);
+    mBuffer.append(QByteArray::number(value));
+    return *this;
+}
+
+JsonRpcWriter &JsonRpcWriter::addRawNumber(const char *key, const QByteArray &value)
+{
+    appendKey(key);
+    mBuffer.append(value);
+    return *this;
+}
+
+QByteArray JsonRpcWriter::finish()
+{
+    mBuffer.append(mHasParams ? "}}" : "}");
+    return mBuffer;
+}
+
+void JsonRpcWriter::appendEscaped(QByteArray &buffer, const QByteArray &utf8)
+{
+    const char *data = utf8.constData();
+    const int size = utf8.size();
+    int start = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        const uchar c = static_cast<uchar>(data[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        buffer.append(data + start, i - start);
+        start = i + 1;
+        switch (c)
+        {
+        case '"':
+            buffer.append("\\\"");
+            break;
+        case '\\':
+            buffer.append("\\\\");
+            break;
+        case '\n':
+            buffer.append("\\n");
+            break;
+        case '\r':
+            buffer.append("\\r");
+            break;
+        case '\t':
+            buffer.append("\\t");
+            break;
+        default:
+            buffer.append("\\u00");
+            buffer.append(scHexDigits[c >> 4]);
+            buffer.append(scHexDigits[c & 0x0f]);
+            break;
+        }
+    }
+    buffer.append(data + start, size - start);
+}
+
+void JsonRpcWriter::appendKey(const char *key)
+{
+    mBuffer.append(mHasParams ? ",\"" : ",\"params\":{\"");
+    mBuffer.append(key);
+    mBuffer.append("\":");
+    mHasParams = true;
+}
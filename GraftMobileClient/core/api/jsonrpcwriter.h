@@ -0,0 +1,51 @@
+#ifndef JSONRPCWRITER_H
+#define JSONRPCWRITER_H
+
+#include <QByteArray>
+#include <QString>
+
+struct DAPIMethod
+{
+    const char *name;
+    int paramsSize;
+    // Idempotent requests may share one network call with identical requests in flight,
+    // duplicates of the other ones are rejected until the first one is answered.
+    bool isIdempotent;
+};
+
+namespace DAPIMethods {
+static const DAPIMethod CreateAccount = {"CreateAccount", 64, false};
+static const DAPIMethod GetWalletBalance = {"GetWalletBalance", 48, true};
+static const DAPIMethod GetSeed = {"GetSeed", 64, true};
+static const DAPIMethod RestoreAccount = {"RestoreAccount", 320, false};
+static const DAPIMethod Sale = {"Sale", 256, false};
+static const DAPIMethod PosRejectSale = {"PosRejectSale", 96, false};
+static const DAPIMethod GetSaleStatus = {"GetSaleStatus", 96, true};
+static const DAPIMethod WalletGetPosData = {"WalletGetPosData", 112, true};
+static const DAPIMethod WalletRejectPay = {"WalletRejectPay", 112, false};
+static const DAPIMethod Pay = {"Pay", 256, false};
+static const DAPIMethod GetPayStatus = {"GetPayStatus", 96, true};
+}
+
+class JsonRpcWriter
+{
+public:
+    JsonRpcWriter(const DAPIMethod &method, const QString &dapiVersion, int extraSize = 0);
+
+    JsonRpcWriter &addString(const char *key, const QString &value);
+    JsonRpcWriter &addRawString(const char *key, const QByteArray &value);
+    JsonRpcWriter &addNumber(const char *key, int value);
+    JsonRpcWriter &addRawNumber(const char *key, const QByteArray &value);
+
+    QByteArray finish();
+
+    static void appendEscaped(QByteArray &buffer, const QByteArray &utf8);
+
+private:
+    void appendKey(const char *key);
+
+    QByteArray mBuffer;
+    bool mHasParams;
+};
+
+#endif // JSONRPCWRITER_H
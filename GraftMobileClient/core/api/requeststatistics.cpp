@@ -0,0 +1,124 @@
+#include "requeststatistics.h"
+#include <QStringList>
+#include <qmath.h>
+
+// Log-linear buckets: the upper bound of bucket i is scBucketRatio^i milliseconds, which keeps
+// the relative error of every percentile under 25% from 1 ms up to 2 minutes.
+static const double scBucketRatio = 1.25;
+static const int scBucketCount = 55;
+
+RequestStatistics::Histogram::Histogram()
+    : buckets(scBucketCount, 0)
+    ,count(0)
+    ,errors(0)
+    ,total(0)
+    ,min(0)
+    ,max(0)
+    ,bytesOut(0)
+    ,bytesIn(0)
+{
+}
+
+RequestStatistics::RequestStatistics(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void RequestStatistics::record(const QString &method, qint64 latency, qint64 bytesOut,
+                               qint64 bytesIn, bool isSucceeded)
+{
+    QMutexLocker locker(&mMutex);
+    Histogram &histogram = mHistograms[method];
+    ++histogram.buckets[bucketIndex(latency)];
+    histogram.min = histogram.count == 0 ? latency : qMin(histogram.min, latency);
+    histogram.max = qMax(histogram.max, latency);
+    ++histogram.count;
+    histogram.total += latency;
+    histogram.bytesOut += bytesOut;
+    histogram.bytesIn += bytesIn;
+    if (!isSucceeded)
+    {
+        ++histogram.errors;
+    }
+    locker.unlock();
+    emit updated(method);
+}
+
+QStringList RequestStatistics::methods() const
+{
+    QMutexLocker locker(&mMutex);
+    QStringList methods = mHistograms.keys();
+    methods.sort();
+    return methods;
+}
+
+int RequestStatistics::count(const QString &method) const
+{
+    QMutexLocker locker(&mMutex);
+    return mHistograms.value(method).count;
+}
+
+double RequestStatistics::percentile(const QString &method, double percent) const
+{
+    QMutexLocker locker(&mMutex);
+    return percentile(mHistograms.value(method), percent);
+}
+
+double RequestStatistics::percentile(const Histogram &histogram, double percent)
+{
+    if (histogram.count == 0)
+    {
+        return 0.0;
+    }
+    const int rank = qMax(1, qCeil(qBound(0.0, percent, 100.0) / 100.0 * histogram.count));
+    int cumulative = 0;
+    for (int i = 0; i < histogram.buckets.count(); ++i)
+    {
+        cumulative += histogram.buckets.at(i);
+        if (cumulative >= rank)
+        {
+            return qBound<double>(histogram.min, bucketUpperBound(i), histogram.max);
+        }
+    }
+    return histogram.max;
+}
+
+QVariantMap RequestStatistics::summary(const QString &method) const
+{
+    QMutexLocker locker(&mMutex);
+    QVariantMap summary;
+    const Histogram histogram = mHistograms.value(method);
+    summary.insert(QStringLiteral("count"), histogram.count);
+    summary.insert(QStringLiteral("errors"), histogram.errors);
+    summary.insert(QStringLiteral("min"), histogram.min);
+    summary.insert(QStringLiteral("max"), histogram.max);
+    summary.insert(QStringLiteral("mean"), histogram.count > 0
+                   ? static_cast<double>(histogram.total) / histogram.count : 0.0);
+    summary.insert(QStringLiteral("p50"), percentile(histogram, 50.0));
+    summary.insert(QStringLiteral("p95"), percentile(histogram, 95.0));
+    summary.insert(QStringLiteral("p99"), percentile(histogram, 99.0));
+    summary.insert(QStringLiteral("bytesOut"), histogram.bytesOut);
+    summary.insert(QStringLiteral("bytesIn"), histogram.bytesIn);
+    return summary;
+}
+
+void RequestStatistics::reset()
+{
+    QMutexLocker locker(&mMutex);
+    mHistograms.clear();
+}
+
+int RequestStatistics::bucketIndex(qint64 latency)
+{
+    if (latency <= 1)
+    {
+        return 0;
+    }
+    const int index = qCeil(qLn(static_cast<double>(latency)) / qLn(scBucketRatio));
+    return qMin(index, scBucketCount - 1);
+}
+
+double RequestStatistics::bucketUpperBound(int index)
+{
+    return qPow(scBucketRatio, index);
+}
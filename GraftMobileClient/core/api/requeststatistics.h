@@ -0,0 +1,51 @@
+#ifndef REQUESTSTATISTICS_H
+#define REQUESTSTATISTICS_H
+
+#include <QVariantMap>
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+
+class RequestStatistics : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RequestStatistics(QObject *parent = nullptr);
+
+    void record(const QString &method, qint64 latency, qint64 bytesOut, qint64 bytesIn,
+                bool isSucceeded);
+
+    Q_INVOKABLE QStringList methods() const;
+    Q_INVOKABLE int count(const QString &method) const;
+    Q_INVOKABLE double percentile(const QString &method, double percent) const;
+    Q_INVOKABLE QVariantMap summary(const QString &method) const;
+    Q_INVOKABLE void reset();
+
+signals:
+    void updated(const QString &method);
+
+private:
+    struct Histogram
+    {
+        Histogram();
+
+        QVector<int> buckets;
+        int count;
+        int errors;
+        qint64 total;
+        qint64 min;
+        qint64 max;
+        qint64 bytesOut;
+        qint64 bytesIn;
+    };
+
+    static double percentile(const Histogram &histogram, double percent);
+    static int bucketIndex(qint64 latency);
+    static double bucketUpperBound(int index);
+
+    mutable QMutex mMutex;
+    QHash<QString, Histogram> mHistograms;
+};
+
+#endif // REQUESTSTATISTICS_H
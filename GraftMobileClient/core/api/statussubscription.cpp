@@ -0,0 +1,255 @@
+#include "statussubscription.h"
+#include "../logger.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSignalBlocker>
+#include <QWebSocket>
+#include <QTimer>
+
+static const int scConnectTimeout = 5000;
+static const int scReconnectInterval = 1000;
+static const int scMaxReconnectInterval = 30000;
+static const int scMethodNotFound = -32601;
+
+StatusSubscription::StatusSubscription(const QString &method, const QString &dapiVersion,
+                                       QObject *parent)
+    : QObject(parent)
+    ,mMethod(method)
+    ,mDAPIVersion(dapiVersion)
+    ,mReconnectAttempt(0)
+    ,mIsSupported(true)
+{
+    mSocket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(mSocket, &QWebSocket::connected, this, &StatusSubscription::receiveConnected);
+    connect(mSocket, &QWebSocket::disconnected, this, &StatusSubscription::receiveDisconnected);
+    connect(mSocket,
+            static_cast<void (QWebSocket::*)(QAbstractSocket::SocketError)>(&QWebSocket::error),
+            this, &StatusSubscription::receiveDisconnected);
+    connect(mSocket, &QWebSocket::textMessageReceived,
+            this, &StatusSubscription::receiveMessage);
+    mConnectTimer = new QTimer(this);
+    mConnectTimer->setSingleShot(true);
+    mConnectTimer->setInterval(scConnectTimeout);
+    connect(mConnectTimer, &QTimer::timeout, mSocket, &QWebSocket::abort);
+    mReconnectTimer = new QTimer(this);
+    mReconnectTimer->setSingleShot(true);
+    connect(mReconnectTimer, &QTimer::timeout, this, &StatusSubscription::reconnect);
+}
+
+void StatusSubscription::setUrl(const QUrl &url)
+{
+    if (mUrl != url)
+    {
+        mUrl = url;
+        mIsSupported = true;
+        mReconnectAttempt = 0;
+        if (mSocket->state() != QAbstractSocket::UnconnectedState)
+        {
+            mSocket->close();
+        }
+    }
+}
+
+QUrl StatusSubscription::url() const
+{
+    return mUrl;
+}
+
+void StatusSubscription::setDAPIVersion(const QString &version)
+{
+    mDAPIVersion = version;
+}
+
+bool StatusSubscription::isSupported() const
+{
+    return mIsSupported;
+}
+
+bool StatusSubscription::isSubscribed(const QString &pid) const
+{
+    return mSubscriptions.contains(pid);
+}
+
+void StatusSubscription::subscribe(const QString &pid)
+{
+    if (!mIsSupported || !mUrl.isValid())
+    {
+        emit failed(pid);
+        return;
+    }
+    mPending.insert(pid);
+    switch (mSocket->state())
+    {
+    case QAbstractSocket::ConnectedState:
+        sendSubscription(pid, true);
+        break;
+    case QAbstractSocket::UnconnectedState:
+        mReconnectTimer->stop();
+        mConnectTimer->start();
+        mSocket->open(subscriptionUrl(mUrl));
+        break;
+    default:
+        break;
+    }
+}
+
+void StatusSubscription::unsubscribe(const QString &pid)
+{
+    const bool isKnown = mPending.remove(pid) | mSubscriptions.remove(pid);
+    if (isKnown && mSocket->state() == QAbstractSocket::ConnectedState)
+    {
+        sendSubscription(pid, false);
+    }
+    if (mPending.isEmpty() && mSubscriptions.isEmpty())
+    {
+        mReconnectTimer->stop();
+        if (mSocket->state() != QAbstractSocket::UnconnectedState)
+        {
+            mSocket->close();
+        }
+    }
+}
+
+QUrl StatusSubscription::subscriptionUrl(const QUrl &url)
+{
+    QUrl subscriptionUrl(url);
+    subscriptionUrl.setScheme(url.scheme() == QLatin1String("https") ? QStringLiteral("wss")
+                                                                     : QStringLiteral("ws"));
+    subscriptionUrl.setPath(url.path() + QStringLiteral("/subscribe"));
+    return subscriptionUrl;
+}
+
+void StatusSubscription::receiveConnected()
+{
+    mConnectTimer->stop();
+    mReconnectAttempt = 0;
+    for (const QString &pid : mPending)
+    {
+        sendSubscription(pid, true);
+    }
+}
+
+void StatusSubscription::receiveDisconnected()
+{
+    // A failure reports both an error and a disconnect, the first one has already scheduled
+    // the reconnect.
+    if (!mReconnectTimer->isActive())
+    {
+        fail(isHandshakeRejected());
+    }
+}
+
+void StatusSubscription::receiveMessage(const QString &message)
+{
+    QJsonObject response = QJsonDocument::fromJson(message.toUtf8()).object();
+    if (response.contains(QLatin1String("error")))
+    {
+        const QJsonObject error = response.value(QLatin1String("error")).toObject();
+        qCInfo(lcStatus) << "Subscription is rejected:" << error.toVariantMap();
+        if (error.value(QLatin1String("code")).toInt() == scMethodNotFound)
+        {
+            fail(true);
+            return;
+        }
+        // Other errors concern a single PID, which goes back to polling. Replies that don't
+        // name a known PID reject every subscription still waiting for an answer.
+        const QString pid = response.value(QLatin1String("id")).toString();
+        QSet<QString> pids;
+        if (mPending.contains(pid) || mSubscriptions.contains(pid))
+        {
+            pids.insert(pid);
+        }
+        else
+        {
+            pids = mPending;
+        }
+        for (const QString &rejected : pids)
+        {
+            mPending.remove(rejected);
+            mSubscriptions.remove(rejected);
+            emit failed(rejected);
+        }
+        return;
+    }
+    QJsonObject result = response.value(QLatin1String("result")).toObject();
+    const QString pid = result.value(QLatin1String("PaymentID")).toString();
+    if (mPending.remove(pid))
+    {
+        mSubscriptions.insert(pid);
+        emit subscribed(pid);
+    }
+    if (mSubscriptions.contains(pid) && result.contains(QLatin1String("Status")))
+    {
+        emit statusReceived(pid, result.value(QLatin1String("Status")).toInt());
+    }
+}
+
+void StatusSubscription::sendSubscription(const QString &pid, bool subscribe)
+{
+    QJsonObject params;
+    params.insert(QStringLiteral("PaymentID"), pid);
+    QJsonObject data;
+    data.insert(QStringLiteral("jsonrpc"), QStringLiteral("2.0"));
+    // Error replies echo the id, so it tells which PID was rejected.
+    data.insert(QStringLiteral("id"), pid);
+    data.insert(QStringLiteral("method"), subscribe ? mMethod : QStringLiteral("Unsubscribe"));
+    data.insert(QStringLiteral("dapi_version"), mDAPIVersion);
+    data.insert(QStringLiteral("params"), params);
+    mSocket->sendTextMessage(QString::fromUtf8(QJsonDocument(data).toJson(QJsonDocument::Compact)));
+}
+
+void StatusSubscription::reconnect()
+{
+    if (mIsSupported && !mPending.isEmpty()
+            && mSocket->state() == QAbstractSocket::UnconnectedState)
+    {
+        mConnectTimer->start();
+        mSocket->open(subscriptionUrl(mUrl));
+    }
+}
+
+void StatusSubscription::fail(bool unsupported)
+{
+    mConnectTimer->stop();
+    if (mSocket->state() != QAbstractSocket::UnconnectedState)
+    {
+        // The disconnect of the abort is this failure, it isn't handled again.
+        const QSignalBlocker blocker(mSocket);
+        mSocket->abort();
+    }
+    const QSet<QString> pids = mPending + mSubscriptions;
+    mSubscriptions.clear();
+    if (unsupported)
+    {
+        // Only a supernode that refuses the endpoint or the method keeps the clients on
+        // polling until the URL changes.
+        mIsSupported = false;
+        mPending.clear();
+        mReconnectTimer->stop();
+    }
+    else
+    {
+        // The PIDs are polled while the connection is retried and subscribed again once it
+        // is back.
+        mPending = pids;
+        if (!mPending.isEmpty())
+        {
+            mReconnectTimer->start(qMin(scReconnectInterval << qMin(mReconnectAttempt, 5),
+                                        scMaxReconnectInterval));
+            ++mReconnectAttempt;
+        }
+    }
+    for (const QString &pid : pids)
+    {
+        emit failed(pid);
+    }
+}
+
+bool StatusSubscription::isHandshakeRejected() const
+{
+    // QWebSocket reports the status of a refused upgrade only in its error string.
+    static const QRegularExpression scStatusPattern(QStringLiteral("status code: (\\d+)"));
+    const int status = scStatusPattern.match(mSocket->errorString()).captured(1).toInt();
+    return status == 400 || status == 404;
+}
@@ -0,0 +1,58 @@
+#ifndef STATUSSUBSCRIPTION_H
+#define STATUSSUBSCRIPTION_H
+
+#include <QObject>
+#include <QSet>
+#include <QUrl>
+
+class QWebSocket;
+class QTimer;
+
+class StatusSubscription : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StatusSubscription(const QString &method, const QString &dapiVersion,
+                                QObject *parent = nullptr);
+
+    void setUrl(const QUrl &url);
+    QUrl url() const;
+    void setDAPIVersion(const QString &version);
+
+    bool isSupported() const;
+    bool isSubscribed(const QString &pid) const;
+
+    void subscribe(const QString &pid);
+    void unsubscribe(const QString &pid);
+
+    static QUrl subscriptionUrl(const QUrl &url);
+
+signals:
+    void subscribed(const QString &pid);
+    void statusReceived(const QString &pid, int status);
+    void failed(const QString &pid);
+
+private slots:
+    void receiveConnected();
+    void receiveDisconnected();
+    void receiveMessage(const QString &message);
+    void reconnect();
+
+private:
+    void sendSubscription(const QString &pid, bool subscribe);
+    void fail(bool unsupported);
+    bool isHandshakeRejected() const;
+
+    QWebSocket *mSocket;
+    QTimer *mConnectTimer;
+    QTimer *mReconnectTimer;
+    int mReconnectAttempt;
+    QUrl mUrl;
+    QString mMethod;
+    QString mDAPIVersion;
+    QSet<QString> mPending;
+    QSet<QString> mSubscriptions;
+    bool mIsSupported;
+};
+
+#endif // STATUSSUBSCRIPTION_H
@@ -0,0 +1,223 @@
+#include "supernodepool.h"
+#include "../logger.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTimer>
+
+static const int scProbeInterval = 30000;
+static const int scProbeTimeout = 5000;
+static const int scMaxFailures = 3;
+static const double scSmoothingFactor = 0.3;
+static const double scUnhealthyErrorRate = 0.5;
+static const double scUnknownLatency = 1000.0;
+
+SupernodePool::SupernodePool(QObject *parent)
+    : QObject(parent)
+{
+    mManager = new QNetworkAccessManager(this);
+    mProbeTimer = new QTimer(this);
+    mProbeTimer->setInterval(scProbeInterval);
+    connect(mProbeTimer, &QTimer::timeout, this, &SupernodePool::probe);
+}
+
+void SupernodePool::setNodes(const QList<QUrl> &urls)
+{
+    QMutexLocker locker(&mMutex);
+    QVector<Node> nodes;
+    for (const QUrl &url : urls)
+    {
+        int index = indexOf(url);
+        if (index >= 0)
+        {
+            nodes.append(mNodes.at(index));
+        }
+        else
+        {
+            Node node;
+            node.url = url;
+            node.latency = scUnknownLatency;
+            node.errorRate = 0.0;
+            node.failures = 0;
+            node.measured = false;
+            nodes.append(node);
+        }
+    }
+    mNodes = nodes;
+    locker.unlock();
+    // The probe timer belongs to the pool's thread.
+    QMetaObject::invokeMethod(this, "restartProbes");
+}
+
+QList<QUrl> SupernodePool::nodes() const
+{
+    QMutexLocker locker(&mMutex);
+    QList<QUrl> urls;
+    for (const Node &node : mNodes)
+    {
+        urls.append(node.url);
+    }
+    return urls;
+}
+
+int SupernodePool::count() const
+{
+    QMutexLocker locker(&mMutex);
+    return mNodes.count();
+}
+
+QUrl SupernodePool::bestUrl(const QList<QUrl> &excluded) const
+{
+    QMutexLocker locker(&mMutex);
+    const Node *best = nullptr;
+    for (const Node &node : mNodes)
+    {
+        if (excluded.contains(node.url))
+        {
+            continue;
+        }
+        if (!best || (isHealthy(node) && !isHealthy(*best))
+            || (isHealthy(node) == isHealthy(*best) && score(node) < score(*best)))
+        {
+            best = &node;
+        }
+    }
+    return best ? best->url : QUrl();
+}
+
+bool SupernodePool::isHealthy(const QUrl &url) const
+{
+    QMutexLocker locker(&mMutex);
+    int index = indexOf(url);
+    return index >= 0 && isHealthy(mNodes.at(index));
+}
+
+double SupernodePool::latency(const QUrl &url) const
+{
+    QMutexLocker locker(&mMutex);
+    int index = indexOf(url);
+    return index >= 0 ? mNodes.at(index).latency : -1.0;
+}
+
+double SupernodePool::errorRate(const QUrl &url) const
+{
+    QMutexLocker locker(&mMutex);
+    int index = indexOf(url);
+    return index >= 0 ? mNodes.at(index).errorRate : 1.0;
+}
+
+void SupernodePool::reportSuccess(const QUrl &url, qint64 latency)
+{
+    QMutexLocker locker(&mMutex);
+    int index = indexOf(url);
+    if (index >= 0)
+    {
+        Node &node = mNodes[index];
+        if (node.measured)
+        {
+            node.latency += scSmoothingFactor * (latency - node.latency);
+        }
+        else
+        {
+            node.latency = latency;
+            node.measured = true;
+        }
+        node.errorRate -= scSmoothingFactor * node.errorRate;
+        node.failures = 0;
+    }
+}
+
+void SupernodePool::reportFailure(const QUrl &url)
+{
+    QMutexLocker locker(&mMutex);
+    int index = indexOf(url);
+    if (index >= 0)
+    {
+        Node &node = mNodes[index];
+        node.errorRate += scSmoothingFactor * (1.0 - node.errorRate);
+        ++node.failures;
+        qCInfo(lcSupernodes) << "Node" << url.toString() << "failed, error rate:"
+                             << node.errorRate;
+    }
+}
+
+void SupernodePool::restartProbes()
+{
+    if (count() == 0)
+    {
+        mProbeTimer->stop();
+    }
+    else
+    {
+        mProbeTimer->start();
+        probe();
+    }
+}
+
+void SupernodePool::probe()
+{
+    for (const QUrl &url : nodes())
+    {
+        QNetworkReply *reply = mManager->head(QNetworkRequest(url));
+        QElapsedTimer timer;
+        timer.start();
+        mProbes.insert(reply, timer);
+        connect(reply, &QNetworkReply::finished, this, &SupernodePool::receiveProbeResponse);
+        QTimer::singleShot(scProbeTimeout, reply, &QNetworkReply::abort);
+    }
+}
+
+void SupernodePool::receiveProbeResponse()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply)
+    {
+        return;
+    }
+    QElapsedTimer timer = mProbes.take(reply);
+    // Any HTTP answer means that the node is reachable, only network layer errors
+    // (refused connection, unknown host, timeout and so on) mark it as failed.
+    if (isTransportError(reply->error()))
+    {
+        reportFailure(reply->request().url());
+    }
+    else
+    {
+        reportSuccess(reply->request().url(), timer.elapsed());
+    }
+    reply->deleteLater();
+    reply = nullptr;
+}
+
+bool SupernodePool::isTransportError(int error)
+{
+    return error != QNetworkReply::NoError && error < QNetworkReply::ProxyConnectionRefusedError;
+}
+
+bool SupernodePool::isConnectionError(int error)
+{
+    // The request never left the device, resending it can't repeat its effect.
+    return error == QNetworkReply::ConnectionRefusedError
+            || error == QNetworkReply::HostNotFoundError;
+}
+
+int SupernodePool::indexOf(const QUrl &url) const
+{
+    for (int i = 0; i < mNodes.count(); ++i)
+    {
+        if (mNodes.at(i).url == url)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool SupernodePool::isHealthy(const Node &node) const
+{
+    return node.failures < scMaxFailures && node.errorRate < scUnhealthyErrorRate;
+}
+
+double SupernodePool::score(const Node &node) const
+{
+    return node.latency / (1.0 - node.errorRate + 0.01);
+}
@@ -0,0 +1,66 @@
+#ifndef SUPERNODEPOOL_H
+#define SUPERNODEPOOL_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include <QObject>
+#include <QVector>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+class SupernodePool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SupernodePool(QObject *parent = nullptr);
+
+    void setNodes(const QList<QUrl> &urls);
+    QList<QUrl> nodes() const;
+    int count() const;
+
+    QUrl bestUrl(const QList<QUrl> &excluded = QList<QUrl>()) const;
+    bool isHealthy(const QUrl &url) const;
+    double latency(const QUrl &url) const;
+    double errorRate(const QUrl &url) const;
+
+    void reportSuccess(const QUrl &url, qint64 latency);
+    void reportFailure(const QUrl &url);
+
+    static bool isTransportError(int error);
+    static bool isConnectionError(int error);
+
+public slots:
+    void probe();
+
+private slots:
+    void restartProbes();
+    void receiveProbeResponse();
+
+private:
+    struct Node
+    {
+        QUrl url;
+        double latency;
+        double errorRate;
+        int failures;
+        bool measured;
+    };
+
+    int indexOf(const QUrl &url) const;
+    bool isHealthy(const Node &node) const;
+    double score(const Node &node) const;
+
+    // Requests report to the pool from the API thread while probes run on the thread that
+    // owns the pool, so the node state is guarded.
+    mutable QMutex mMutex;
+    QNetworkAccessManager *mManager;
+    QTimer *mProbeTimer;
+    QVector<Node> mNodes;
+    QHash<QNetworkReply *, QElapsedTimer> mProbes;
+};
+
+#endif // SUPERNODEPOOL_H
@@ -1,33 +1,119 @@
 #include "barcodeimageprovider.h"
 
+#include <QRunnable>
+
+static const int scDefaultSize = 300;
+static const int scDefaultCacheBudget = 8 * 1024 * 1024;
+static const int scEncoderThreadCount = 2;
+
+namespace {
+class BarcodeResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+    BarcodeResponse(BarcodeImageProvider *provider, const QString &id, const QSize &size)
+        : mProvider(provider)
+        ,mId(id)
+        ,mSize(size)
+    {
+        setAutoDelete(false);
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(mImage);
+    }
+
+    void run() override
+    {
+        mImage = mProvider->barcodeImage(mId, mSize);
+        emit finished();
+    }
+
+private:
+    BarcodeImageProvider *mProvider;
+    QString mId;
+    QSize mSize;
+    QImage mImage;
+};
+}
+
 BarcodeImageProvider::BarcodeImageProvider()
-    : QQuickImageProvider(QQuickImageProvider::Image)
+    : QQuickAsyncImageProvider()
+    ,mImages(scDefaultCacheBudget)
 {
+    mPool.setMaxThreadCount(scEncoderThreadCount);
 }
 
-void BarcodeImageProvider::setBarcodeImage(const QString &id, const QImage &image)
+BarcodeImageProvider::~BarcodeImageProvider()
 {
-    mBarcodes.insert(id, image);
+    mPool.waitForDone();
 }
 
-QImage BarcodeImageProvider::barcodeImage(const QString &id) const
+void BarcodeImageProvider::setBarcode(const QString &id, const QString &message,
+                                      QRCodeGenerator::ErrorCorrection level)
 {
-    return mBarcodes.value(id);
+    QMutexLocker locker(&mMutex);
+    mBarcodes.insert(id, {message, level});
 }
 
-QImage BarcodeImageProvider::requestImage(const QString &id, QSize *size,
-                                          const QSize &requestedSize)
+QString BarcodeImageProvider::barcode(const QString &id) const
 {
-    QImage image = mBarcodes.value(id);
-    if (size)
+    QMutexLocker locker(&mMutex);
+    return mBarcodes.value(id).message;
+}
+
+void BarcodeImageProvider::setCacheBudget(int bytes)
+{
+    QMutexLocker locker(&mMutex);
+    mImages.setMaxCost(bytes);
+}
+
+int BarcodeImageProvider::cacheBudget() const
+{
+    QMutexLocker locker(&mMutex);
+    return mImages.maxCost();
+}
+
+QQuickImageResponse *BarcodeImageProvider::requestImageResponse(const QString &id,
+                                                                const QSize &requestedSize)
+{
+    BarcodeResponse *response = new BarcodeResponse(this, id, requestedSize);
+    mPool.start(response);
+    return response;
+}
+
+QImage BarcodeImageProvider::barcodeImage(const QString &id, const QSize &requestedSize)
+{
+    // Codes are rendered at the requested size instead of being scaled, the shorter side wins
+    // as the code is square.
+    int side = scDefaultSize;
+    if (requestedSize.width() > 0 && requestedSize.height() > 0)
+    {
+        side = qMin(requestedSize.width(), requestedSize.height());
+    }
+    else if (requestedSize.width() > 0 || requestedSize.height() > 0)
     {
-        *size = image.size();
+        side = qMax(requestedSize.width(), requestedSize.height());
     }
-    if (!image.isNull())
+    Barcode barcode;
+    QString key;
     {
-        return image.scaled(requestedSize.width() > 0 ? requestedSize.width() : image.width(),
-                            requestedSize.height() > 0 ? requestedSize.height() : image.height(),
-                            Qt::KeepAspectRatio);
+        QMutexLocker locker(&mMutex);
+        barcode = mBarcodes.value(id);
+        if (barcode.message.isEmpty())
+        {
+            return QImage();
+        }
+        key = QString::number(barcode.level) + QLatin1Char(':') + QString::number(side)
+                + QLatin1Char(':') + barcode.message;
+        if (QImage *cached = mImages.object(key))
+        {
+            return *cached;
+        }
     }
+    // The lock isn't held while encoding, so different codes are rendered in parallel.
+    const QImage image = mEncoder.encode(barcode.message, side, barcode.level);
+    QMutexLocker locker(&mMutex);
+    mImages.insert(key, new QImage(image), image.byteCount());
     return image;
 }
@@ -1,20 +1,43 @@
 #ifndef BARCODEIMAGEPROVIDER_H
 #define BARCODEIMAGEPROVIDER_H
 
-#include <QQuickImageProvider>
+#include "qrcodegenerator.h"
+#include <QQuickAsyncImageProvider>
+#include <QThreadPool>
+#include <QCache>
+#include <QMutex>
 
-class BarcodeImageProvider : public QQuickImageProvider
+class BarcodeImageProvider : public QQuickAsyncImageProvider
 {
 public:
     BarcodeImageProvider();
+    ~BarcodeImageProvider();
 
-    void setBarcodeImage(const QString &id, const QImage &image);
-    QImage barcodeImage(const QString &id) const;
+    void setBarcode(const QString &id, const QString &message,
+                    QRCodeGenerator::ErrorCorrection level = QRCodeGenerator::Quartile);
+    QString barcode(const QString &id) const;
 
-    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+    void setCacheBudget(int bytes);
+    int cacheBudget() const;
+
+    QQuickImageResponse *requestImageResponse(const QString &id,
+                                              const QSize &requestedSize) override;
+
+    QImage barcodeImage(const QString &id, const QSize &requestedSize);
 
 private:
-    QMap<QString, QImage> mBarcodes;
+    struct Barcode
+    {
+        QString message;
+        QRCodeGenerator::ErrorCorrection level;
+    };
+
+    QRCodeGenerator mEncoder;
+    QThreadPool mPool;
+    mutable QMutex mMutex;
+    QMap<QString, Barcode> mBarcodes;
+    // Rendered images by message, error correction level and size, the cost is their byte size.
+    QCache<QString, QImage> mImages;
 };
 
 #endif // BARCODEIMAGEPROVIDER_H
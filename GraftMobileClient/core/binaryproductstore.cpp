@@ -0,0 +1,219 @@
+#include "binaryproductstore.h"
+#include "logger.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+#include <QHash>
+
+#include <cstring>
+
+// Layout, all integers little endian:
+//   header:  magic "GCAT", quint32 version, quint32 record count, quint32 record size,
+//            quint64 string table offset, since version 2 followed by quint32 journal
+//            generation and quint32 reserved
+//   records: record count fixed size records, see below
+//   strings: quint32 byte length followed by UTF-8 bytes, each distinct string stored once
+// A record holds the cost as an IEEE 754 double followed by the string table offsets of the
+// image name, name, currency and description, and eight reserved bytes.
+static const char scMagic[4] = {'G', 'C', 'A', 'T'};
+static const quint32 scVersion = 2;
+static const int scVersion1HeaderSize = 24;
+static const int scHeaderSize = 32;
+static const int scRecordSize = 32;
+
+namespace {
+quint64 doubleToBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsToDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template <typename T>
+void appendValue(QByteArray &buffer, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    buffer.append(reinterpret_cast<const char *>(bytes), sizeof(T));
+}
+
+class StringTable
+{
+public:
+    quint32 add(const QString &string)
+    {
+        QHash<QString, quint32>::const_iterator it = mOffsets.constFind(string);
+        if (it != mOffsets.constEnd())
+        {
+            return it.value();
+        }
+        const quint32 offset = static_cast<quint32>(mData.size());
+        const QByteArray utf8 = string.toUtf8();
+        appendValue<quint32>(mData, static_cast<quint32>(utf8.size()));
+        mData.append(utf8);
+        mOffsets.insert(string, offset);
+        return offset;
+    }
+
+    const QByteArray &data() const
+    {
+        return mData;
+    }
+
+private:
+    QHash<QString, quint32> mOffsets;
+    QByteArray mData;
+};
+}
+
+BinaryProductStore::BinaryProductStore(const QString &fileName)
+    : mFile(fileName)
+    ,mData(nullptr)
+    ,mSize(0)
+    ,mCount(0)
+    ,mStringTableOffset(0)
+    ,mHeaderSize(0)
+    ,mGeneration(0)
+{
+    if (!mFile.open(QIODevice::ReadOnly) || mFile.size() < scVersion1HeaderSize)
+    {
+        return;
+    }
+    const uchar *data = mFile.map(0, mFile.size());
+    if (!data)
+    {
+        return;
+    }
+    const qint64 size = mFile.size();
+    const quint32 version = qFromLittleEndian<quint32>(data + 4);
+    const int headerSize = version == 1 ? scVersion1HeaderSize : scHeaderSize;
+    const quint32 count = qFromLittleEndian<quint32>(data + 8);
+    const quint64 stringTableOffset = qFromLittleEndian<quint64>(data + 16);
+    if (std::memcmp(data, scMagic, sizeof(scMagic)) != 0
+            || version < 1 || version > scVersion || size < headerSize
+            || qFromLittleEndian<quint32>(data + 12) != scRecordSize
+            || stringTableOffset != headerSize + quint64(count) * scRecordSize
+            || stringTableOffset > quint64(size))
+    {
+        qCWarning(lcCatalog) << "Catalog" << mFile.fileName() << "has an unknown format.";
+        mFile.unmap(const_cast<uchar *>(data));
+        return;
+    }
+    mHeaderSize = headerSize;
+    mGeneration = version == 1 ? 0 : qFromLittleEndian<quint32>(data + 24);
+    mData = data;
+    mSize = size;
+    mCount = count;
+    mStringTableOffset = stringTableOffset;
+}
+
+BinaryProductStore::~BinaryProductStore()
+{
+    if (mData)
+    {
+        mFile.unmap(const_cast<uchar *>(mData));
+    }
+}
+
+bool BinaryProductStore::isValid() const
+{
+    return mData;
+}
+
+int BinaryProductStore::count() const
+{
+    return static_cast<int>(mCount);
+}
+
+quint32 BinaryProductStore::generation() const
+{
+    return mGeneration;
+}
+
+QVector<ProductItem> BinaryProductStore::read(int first, int count) const
+{
+    QVector<ProductItem> items;
+    const int begin = qMax(0, first);
+    const int end = qMin(first + count, this->count());
+    if (!mData || begin >= end)
+    {
+        return items;
+    }
+    items.reserve(end - begin);
+    for (int i = begin; i < end; ++i)
+    {
+        const uchar *record = mData + mHeaderSize + qint64(i) * scRecordSize;
+        items.append(ProductItem(string(qFromLittleEndian<quint32>(record + 8)),
+                                 string(qFromLittleEndian<quint32>(record + 12)),
+                                 bitsToDouble(qFromLittleEndian<quint64>(record)),
+                                 string(qFromLittleEndian<quint32>(record + 16)),
+                                 string(qFromLittleEndian<quint32>(record + 20))));
+    }
+    return items;
+}
+
+bool BinaryProductStore::save(const QString &fileName, const QVector<ProductItem> &items,
+                              quint32 generation)
+{
+    StringTable strings;
+    QByteArray records;
+    records.reserve(items.count() * scRecordSize);
+    for (const ProductItem &item : items)
+    {
+        appendValue<quint64>(records, doubleToBits(item.cost()));
+        appendValue<quint32>(records, strings.add(item.imageName()));
+        appendValue<quint32>(records, strings.add(item.name()));
+        appendValue<quint32>(records, strings.add(item.currency()));
+        appendValue<quint32>(records, strings.add(item.description()));
+        appendValue<quint64>(records, 0);
+    }
+    QByteArray header;
+    header.append(scMagic, sizeof(scMagic));
+    appendValue<quint32>(header, scVersion);
+    appendValue<quint32>(header, static_cast<quint32>(items.count()));
+    appendValue<quint32>(header, scRecordSize);
+    appendValue<quint64>(header, scHeaderSize + quint64(records.size()));
+    appendValue<quint32>(header, generation);
+    appendValue<quint32>(header, 0);
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(lcCatalog) << "Catalog" << fileName << "couldn't be opened:"
+                             << file.errorString();
+        return false;
+    }
+    file.write(header);
+    file.write(records);
+    file.write(strings.data());
+    if (!file.commit())
+    {
+        qCWarning(lcCatalog) << "Catalog" << fileName << "couldn't be written:"
+                             << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString BinaryProductStore::string(quint32 offset) const
+{
+    const quint64 position = mStringTableOffset + offset;
+    if (position + sizeof(quint32) > quint64(mSize))
+    {
+        return QString();
+    }
+    const quint32 length = qFromLittleEndian<quint32>(mData + position);
+    if (position + sizeof(quint32) + length > quint64(mSize))
+    {
+        return QString();
+    }
+    return QString::fromUtf8(reinterpret_cast<const char *>(mData + position + sizeof(quint32)),
+                             static_cast<int>(length));
+}
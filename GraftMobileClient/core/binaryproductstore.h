@@ -0,0 +1,33 @@
+#ifndef BINARYPRODUCTSTORE_H
+#define BINARYPRODUCTSTORE_H
+
+#include "productstore.h"
+#include <QFile>
+
+class BinaryProductStore : public ProductStore
+{
+public:
+    explicit BinaryProductStore(const QString &fileName);
+    ~BinaryProductStore();
+
+    bool isValid() const;
+    int count() const override;
+    QVector<ProductItem> read(int first, int count) const override;
+    quint32 generation() const;
+
+    static bool save(const QString &fileName, const QVector<ProductItem> &items,
+                     quint32 generation = 0);
+
+private:
+    QString string(quint32 offset) const;
+
+    QFile mFile;
+    const uchar *mData;
+    qint64 mSize;
+    quint32 mCount;
+    quint64 mStringTableOffset;
+    int mHeaderSize;
+    quint32 mGeneration;
+};
+
+#endif // BINARYPRODUCTSTORE_H
@@ -3,8 +3,15 @@
 
 #include <QStandardPaths>
 
+static const QString scThumbnailImageProviderID("thumbnails");
+
 static QString callImageDataPath()
 {
     return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).append("/ImageProduct/");
 }
+
+static QString callThumbnailCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation).append("/Thumbnails/");
+}
 #endif // DEFINES_H
@@ -1,10 +1,12 @@
 #include "accountmodelserializator.h"
 #include "barcodeimageprovider.h"
 #include "api/graftgenericapi.h"
+#include "api/graftapithread.h"
+#include "api/requeststatistics.h"
+#include "api/supernodepool.h"
 #include "quickexchangemodel.h"
 #include "graftclienttools.h"
 #include "graftbaseclient.h"
-#include "qrcodegenerator.h"
 #include "accountmanager.h"
 #include "currencymodel.h"
 #include "currencyitem.h"
@@ -33,26 +35,34 @@ static const QString scSettingsDataFile("Settings.ini");
 GraftBaseClient::GraftBaseClient(QObject *parent)
     : QObject(parent)
     ,mImageProvider(nullptr)
-    ,mQRCodeEncoder(new QRCodeGenerator())
     ,mClientSettings(nullptr)
     ,mAccountModel(nullptr)
     ,mCurrencyModel(nullptr)
     ,mQuickExchangeModel(nullptr)
     ,mBalanceTimer(-1)
     ,mAccountManager(new AccountManager())
+    ,mApiThread(new GraftAPIThread(this))
+    ,mSupernodePool(new SupernodePool())
+    ,mRequestStatistics(new RequestStatistics(this))
 {
+    // Probes run next to the requests, the GUI thread only reads the pool.
+    mApiThread->attach(mSupernodePool);
     initSettings();
+    updateSupernodes();
 }
 
 GraftBaseClient::~GraftBaseClient()
 {
-    delete mQRCodeEncoder;
+    // The API objects and the pool they report to go away with the thread, before the members
+    // they point to.
+    mApiThread->stop();
     delete mAccountManager;
 }
 
 void GraftBaseClient::setNetworkType(int networkType)
 {
     mAccountManager->setNetworkType(networkType);
+    updateSupernodes();
     emit networkTypeChanged();
 }
 
@@ -105,11 +115,16 @@ QuickExchangeModel *GraftBaseClient::quickExchangeModel() const
     return mQuickExchangeModel;
 }
 
-void GraftBaseClient::setQRCodeImage(const QImage &image)
+RequestStatistics *GraftBaseClient::requestStatistics() const
+{
+    return mRequestStatistics;
+}
+
+void GraftBaseClient::setQRCodeText(const QString &text, QRCodeGenerator::ErrorCorrection level)
 {
     if (mImageProvider)
     {
-        mImageProvider->setBarcodeImage(scQRCodeImageID, image);
+        mImageProvider->setBarcode(scQRCodeImageID, text, level);
     }
 }
 
@@ -119,6 +134,8 @@ void GraftBaseClient::registerTypes(QQmlEngine *engine)
     initAccountModel(engine);
     initCurrencyModel(engine);
     initQuickExchangeModel(engine);
+    engine->rootContext()->setContextProperty(QStringLiteral("RequestStatistics"),
+                                              mRequestStatistics);
     qmlRegisterUncreatableType<GraftClientTools>("org.graft", 1, 0,
                                                  "GraftClientTools",
                                                  "You cannot create an instance of GraftClientTools type.");
@@ -131,7 +148,7 @@ QString GraftBaseClient::qrCodeImage() const
 
 QString GraftBaseClient::addressQRCodeImage() const
 {
-    if (mImageProvider && mImageProvider->barcodeImage(scAddressQRCodeImageID).isNull())
+    if (mImageProvider && mImageProvider->barcode(scAddressQRCodeImageID).isEmpty())
     {
         updateAddressQRCode();
     }
@@ -140,7 +157,7 @@ QString GraftBaseClient::addressQRCodeImage() const
 
 QString GraftBaseClient::coinAddressQRCodeImage(const QString &address) const
 {
-    mImageProvider->setBarcodeImage(scCoinAddressQRCodeImageID, mQRCodeEncoder->encode(address));
+    mImageProvider->setBarcode(scCoinAddressQRCodeImageID, address);
     return scProviderScheme.arg(scBarcodeImageProviderID).arg(scCoinAddressQRCodeImageID);
 }
 
@@ -197,6 +214,16 @@ QByteArray GraftBaseClient::loadModel(const QString &fileName) const
     return QByteArray();
 }
 
+QString GraftBaseClient::modelFilePath(const QString &fileName) const
+{
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (!QFileInfo(dataPath).exists())
+    {
+        QDir().mkpath(dataPath);
+    }
+    return QDir(dataPath).filePath(fileName);
+}
+
 QUrl GraftBaseClient::getServiceUrl() const
 {
     QString finalUrl;
@@ -208,6 +235,11 @@ QUrl GraftBaseClient::getServiceUrl() const
     }
     else
     {
+        QUrl url = mSupernodePool->bestUrl();
+        if (url.isValid())
+        {
+            return url;
+        }
         QStringList seedNodes = seedSupernodes();
         finalUrl = seedNodes.value(qrand() % seedNodes.count());
     }
@@ -223,11 +255,15 @@ void GraftBaseClient::requestAccount(GraftGenericAPI *api, const QString &passwo
             connect(api, &GraftGenericAPI::createAccountReceived,
                     this, &GraftBaseClient::receiveAccount, Qt::UniqueConnection);
             mAccountManager->setPassword(password);
-            api->createAccount(password);
+            mApiThread->invoke([api, password] { api->createAccount(password); });
         }
         else
         {
-            api->setAccountData(mAccountManager->account(), mAccountManager->passsword());
+            const QByteArray account = mAccountManager->account();
+            const QString accountPassword = mAccountManager->passsword();
+            mApiThread->invoke([api, account, accountPassword] {
+                api->setAccountData(account, accountPassword);
+            });
         }
     }
 }
@@ -240,7 +276,7 @@ void GraftBaseClient::requestRestoreAccount(GraftGenericAPI *api, const QString
         connect(api, &GraftGenericAPI::restoreAccountReceived,
                 this, &GraftBaseClient::receiveRestoreAccount, Qt::UniqueConnection);
         mAccountManager->setPassword(password);
-        api->restoreAccount(seed, password);
+        mApiThread->invoke([api, seed, password] { api->restoreAccount(seed, password); });
     }
 }
 
@@ -254,6 +290,22 @@ void GraftBaseClient::registerBalanceTimer(GraftGenericAPI *api)
     }
 }
 
+void GraftBaseClient::registerSupernodePool(GraftGenericAPI *api)
+{
+    if (api && !useOwnServiceAddress())
+    {
+        api->setSupernodePool(mSupernodePool);
+    }
+}
+
+void GraftBaseClient::registerRequestStatistics(GraftGenericAPI *api)
+{
+    if (api)
+    {
+        api->setStatistics(mRequestStatistics);
+    }
+}
+
 void GraftBaseClient::receiveAccount(const QByteArray &accountData, const QString &password,
                                      const QString &address, const QString &viewKey,
                                      const QString &seed)
@@ -261,10 +313,12 @@ void GraftBaseClient::receiveAccount(const QByteArray &accountData, const QStrin
     bool isAccountCreated = false;
     if (mAccountManager->passsword() == password && !accountData.isEmpty() && !address.isEmpty())
     {
+        mAccountManager->beginUpdate();
         mAccountManager->setAccount(accountData);
         mAccountManager->setAddress(address);
         mAccountManager->setViewKey(viewKey);
         mAccountManager->setSeed(seed);
+        mAccountManager->endUpdate();
         updateAddressQRCode();
         isAccountCreated = true;
     }
@@ -278,10 +332,12 @@ void GraftBaseClient::receiveRestoreAccount(const QByteArray &accountData, const
     bool isAccountRestored = false;
     if (mAccountManager->passsword() == password && !accountData.isEmpty() &&!address.isEmpty())
     {
+        mAccountManager->beginUpdate();
         mAccountManager->setAccount(accountData);
         mAccountManager->setAddress(address);
         mAccountManager->setViewKey(viewKey);
         mAccountManager->setSeed(seed);
+        mAccountManager->endUpdate();
         updateAddressQRCode();
         isAccountRestored = true;
     }
@@ -345,7 +401,20 @@ void GraftBaseClient::initQuickExchangeModel(QQmlEngine *engine)
 
 void GraftBaseClient::updateAddressQRCode() const
 {
-    mImageProvider->setBarcodeImage(scAddressQRCodeImageID, mQRCodeEncoder->encode(address()));
+    mImageProvider->setBarcode(scAddressQRCodeImageID, address());
+}
+
+void GraftBaseClient::updateSupernodes()
+{
+    QList<QUrl> nodes;
+    if (!useOwnServiceAddress())
+    {
+        for (const QString &node : seedSupernodes())
+        {
+            nodes.append(QUrl(scUrl.arg(node)));
+        }
+    }
+    mSupernodePool->setNodes(nodes);
 }
 
 void GraftBaseClient::setSettings(const QString &key, const QVariant &value)
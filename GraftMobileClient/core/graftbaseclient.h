@@ -4,12 +4,15 @@
 #include <QObject>
 #include <QVariant>
 #include "graftclienttools.h"
+#include "qrcodegenerator.h"
 
 class BarcodeImageProvider;
 class QuickExchangeModel;
 class GraftGenericAPI;
-class QRCodeGenerator;
+class GraftAPIThread;
+class RequestStatistics;
 class AccountManager;
+class SupernodePool;
 class CurrencyModel;
 class AccountModel;
 class QQmlEngine;
@@ -36,8 +39,10 @@ public:
     AccountModel *accountModel() const;
     CurrencyModel *currencyModel() const;
     QuickExchangeModel *quickExchangeModel() const;
+    RequestStatistics *requestStatistics() const;
 
-    void setQRCodeImage(const QImage &image);
+    void setQRCodeText(const QString &text,
+                       QRCodeGenerator::ErrorCorrection level = QRCodeGenerator::Quartile);
     virtual void registerTypes(QQmlEngine *engine);
 
     Q_INVOKABLE QString qrCodeImage() const;
@@ -79,11 +84,14 @@ protected:
     void registerImageProvider(QQmlEngine *engine);
     void saveModel(const QString &fileName,const QByteArray &data) const;
     QByteArray loadModel(const QString &fileName) const;
+    QString modelFilePath(const QString &fileName) const;
     QUrl getServiceUrl() const;
     void requestAccount(GraftGenericAPI *api, const QString &password);
     void requestRestoreAccount(GraftGenericAPI *api, const QString &seed, const QString &password);
 
     void registerBalanceTimer(GraftGenericAPI *api);
+    void registerSupernodePool(GraftGenericAPI *api);
+    void registerRequestStatistics(GraftGenericAPI *api);
     virtual void updateBalance() = 0;
 
 private slots:
@@ -101,14 +109,17 @@ private:
     void initCurrencyModel(QQmlEngine *engine);
     void initQuickExchangeModel(QQmlEngine *engine);
     void updateAddressQRCode() const;
+    void updateSupernodes();
 
 protected:
     BarcodeImageProvider *mImageProvider;
-    QRCodeGenerator *mQRCodeEncoder;
     AccountModel *mAccountModel;
     CurrencyModel *mCurrencyModel;
     QuickExchangeModel *mQuickExchangeModel;
     AccountManager *mAccountManager;
+    GraftAPIThread *mApiThread;
+    SupernodePool *mSupernodePool;
+    RequestStatistics *mRequestStatistics;
     QSettings *mClientSettings;
 
     QMap<int, double> mBalances;
@@ -1,35 +1,72 @@
 #include "selectedproductproxymodel.h"
 #include "productmodelserializator.h"
-#include "qrcodegenerator.h"
+#include "productsearchmodel.h"
+#include "binaryproductstore.h"
+#include "productjournal.h"
+#include "salepayload.h"
+#include "thumbnailimageprovider.h"
+#ifdef SQL_PRODUCT_CATALOG
+#include "sqlproductstore.h"
+#endif
+#include "api/statussubscription.h"
+#include "api/graftapithread.h"
 #include "api/graftposapi.h"
 #include "graftposclient.h"
+#include "statuspoller.h"
 #include "accountmanager.h"
 #include "keygenerator.h"
+#include "logger.h"
 #include "productmodel.h"
+#include "defines.h"
 #include "config.h"
 
 #include <QStandardPaths>
+#include <QQmlEngine>
 #include <QSettings>
 #include <QFileInfo>
+#include <QFile>
 
 static const QString scProductModelDataFile("productList.dat");
+static const QString scProductCatalogFile("productCatalog.bin");
+// Wallets released before the compact payload only read "pid;address;amount;block", so it is
+// opt-in until they are out of use.
+static const QString scCompactSaleQRCodeKey("compactSaleQRCode");
+#ifdef SQL_PRODUCT_CATALOG
+static const QString scProductDatabaseFile("productCatalog.db");
+#endif
 
 GraftPOSClient::GraftPOSClient(QObject *parent)
     : GraftBaseClient(parent)
 {
-    mApi = new GraftPOSAPI(getServiceUrl(), dapiVersion(), this);
+    mApi = new GraftPOSAPI(getServiceUrl(), dapiVersion());
     connect(mApi, &GraftPOSAPI::saleResponseReceived, this, &GraftPOSClient::receiveSale);
     connect(mApi, &GraftPOSAPI::rejectSaleResponseReceived,
             this, &GraftPOSClient::receiveRejectSale);
     connect(mApi, &GraftPOSAPI::getSaleStatusResponseReceived,
             this, &GraftPOSClient::receiveSaleStatus);
     connect(mApi, &GraftPOSAPI::error, this, &GraftPOSClient::errorReceived);
+    mStatusPoller = new StatusPoller(this);
+    connect(mStatusPoller, &StatusPoller::pollRequested, mApi, &GraftPOSAPI::getSaleStatus);
+    connect(mStatusPoller, &StatusPoller::deadlineExpired,
+            this, &GraftPOSClient::receiveSaleStatusDeadline);
+    connect(mApi, &GraftPOSAPI::getSaleStatusFailed, this, &GraftPOSClient::retrySaleStatus);
+    mStatusSubscription = new StatusSubscription(QStringLiteral("SubscribeSaleStatus"),
+                                                 dapiVersion(), this);
+    connect(mStatusSubscription, &StatusSubscription::subscribed,
+            mStatusPoller, &StatusPoller::suspend);
+    connect(mStatusSubscription, &StatusSubscription::failed,
+            mStatusPoller, &StatusPoller::resume);
+    connect(mStatusSubscription, &StatusSubscription::statusReceived,
+            this, &GraftPOSClient::receiveSubscribedSaleStatus);
     initProductModels();
     if (isAccountExists())
     {
         mApi->setAccountData(mAccountManager->account(), mAccountManager->passsword());
     }
     registerBalanceTimer(mApi);
+    registerSupernodePool(mApi);
+    registerRequestStatistics(mApi);
+    mApiThread->attach(mApi);
 }
 
 GraftPOSClient::~GraftPOSClient()
@@ -39,7 +76,9 @@ GraftPOSClient::~GraftPOSClient()
 void GraftPOSClient::setNetworkType(int networkType)
 {
     GraftBaseClient::setNetworkType(networkType);
-    mApi->setDAPIVersion(dapiVersion());
+    const QString version = dapiVersion();
+    mApiThread->invoke([this, version] { mApi->setDAPIVersion(version); });
+    mStatusSubscription->setDAPIVersion(dapiVersion());
 }
 
 ProductModel *GraftPOSClient::productModel() const
@@ -52,16 +91,29 @@ SelectedProductProxyModel *GraftPOSClient::selectedProductModel() const
     return mSelectedProductModel;
 }
 
+ProductSearchModel *GraftPOSClient::productSearchModel() const
+{
+    return mProductSearchModel;
+}
+
+
 void GraftPOSClient::registerTypes(QQmlEngine *engine)
 {
     GraftBaseClient::registerTypes(engine);
+    engine->addImageProvider(scThumbnailImageProviderID,
+                             new ThumbnailImageProvider(callImageDataPath(),
+                                                        callThumbnailCachePath()));
 }
 
 bool GraftPOSClient::resetUrl(const QString &ip, const QString &port)
 {
     if (GraftBaseClient::resetUrl(ip, port))
     {
-        mApi->setUrl(QUrl(scUrl.arg(QString("%1:%2").arg(ip).arg(port))));
+        const QUrl url(scUrl.arg(QString("%1:%2").arg(ip).arg(port)));
+        mApiThread->invoke([this, url] {
+            mApi->setSupernodePool(nullptr);
+            mApi->setUrl(url);
+        });
         return true;
     }
     return false;
@@ -77,9 +129,38 @@ void GraftPOSClient::restoreAccount(const QString &seed, const QString &password
     GraftBaseClient::requestRestoreAccount(mApi, seed, password);
 }
 
+#ifdef SQL_PRODUCT_CATALOG
+// Sorted or filtered rows move on every edit, the model reloads them and starts a new selection.
+void GraftPOSClient::sortCatalog(int order, bool isAscending)
+{
+    if (order < SqlProductStore::PositionOrder || order > SqlProductStore::CurrencyOrder)
+    {
+        qCWarning(lcCatalog) << "Unknown catalog order" << order;
+        return;
+    }
+    SqlProductStore *database = dynamic_cast<SqlProductStore *>(mProductModel->store());
+    if (database)
+    {
+        database->setOrder(static_cast<SqlProductStore::Order>(order),
+                           isAscending ? Qt::AscendingOrder : Qt::DescendingOrder);
+        mProductModel->reload();
+    }
+}
+
+void GraftPOSClient::filterCatalog(const QString &currency, const QString &name)
+{
+    SqlProductStore *database = dynamic_cast<SqlProductStore *>(mProductModel->store());
+    if (database)
+    {
+        database->setFilter(currency, name);
+        mProductModel->reload();
+    }
+}
+#endif
+
 void GraftPOSClient::saveProducts() const
 {
-    saveModel(scProductModelDataFile, ProductModelSerializator::serialize(mProductModel));
+    mProductModel->store()->flush();
 }
 
 void GraftPOSClient::sale()
@@ -87,9 +168,14 @@ void GraftPOSClient::sale()
     if (mProductModel->totalCost() > 0)
     {
         updateQuickExchange(mProductModel->totalCost());
-        QByteArray selectedProducts = ProductModelSerializator::serialize(mProductModel, true);
-        mApi->sale(mAccountManager->address(), mAccountManager->viewKey(),
-                   mProductModel->totalCost(), selectedProducts.toHex());
+        const QByteArray selectedProducts =
+                ProductModelSerializator::serialize(mProductModel, true).toHex();
+        const QString address = mAccountManager->address();
+        const QString viewKey = mAccountManager->viewKey();
+        const double amount = mProductModel->totalCost();
+        mApiThread->invoke([this, address, viewKey, amount, selectedProducts] {
+            mApi->sale(address, viewKey, amount, selectedProducts);
+        });
     }
     else
     {
@@ -99,21 +185,35 @@ void GraftPOSClient::sale()
 
 void GraftPOSClient::rejectSale()
 {
-    mApi->rejectSale(mPID);
+    mStatusPoller->cancel(mPID);
+    mStatusSubscription->unsubscribe(mPID);
+    const QString pid = mPID;
+    mApiThread->invoke([this, pid] { mApi->rejectSale(pid); });
 }
 
 void GraftPOSClient::getSaleStatus()
 {
-    mApi->getSaleStatus(mPID);
+    mStatusPoller->start(mPID);
+    mStatusSubscription->setUrl(getServiceUrl());
+    mStatusSubscription->subscribe(mPID);
 }
 
 void GraftPOSClient::receiveSale(int result, const QString &pid, int blockNum)
 {
     const bool isStatusOk = (result == 0);
     mPID = pid;
-    QString qrText = QString("%1;%2;%3;%4").arg(pid).arg(mAccountManager->address())
-            .arg(mProductModel->totalCost()).arg(blockNum);
-    setQRCodeImage(mQRCodeEncoder->encode(qrText));
+    const SalePayload payload(pid, mAccountManager->address(), mProductModel->totalCost(),
+                              blockNum);
+    const QString compactText = settings(scCompactSaleQRCodeKey).toBool()
+            ? payload.toCompactText() : QString();
+    if (compactText.isEmpty())
+    {
+        setQRCodeText(payload.toText());
+    }
+    else
+    {
+        setQRCodeText(compactText, QRCodeGenerator::Adaptive);
+    }
     emit saleReceived(isStatusOk);
     if (isStatusOk)
     {
@@ -128,12 +228,20 @@ void GraftPOSClient::receiveRejectSale(int result)
 
 void GraftPOSClient::receiveSaleStatus(int result, int saleStatus)
 {
+    if (!mStatusPoller->isActive(mPID))
+    {
+        return;
+    }
+    if (result == 0 && saleStatus == GraftPOSAPI::StatusProcessing)
+    {
+        mStatusPoller->next(mPID);
+        return;
+    }
+    mStatusPoller->stop(mPID);
+    mStatusSubscription->unsubscribe(mPID);
     if (result == 0)
     {
         switch (saleStatus) {
-        case GraftPOSAPI::StatusProcessing:
-            getSaleStatus();
-            break;
         case GraftPOSAPI::StatusApproved:
             emit saleStatusReceived(true);
             break;
@@ -152,15 +260,90 @@ void GraftPOSClient::receiveSaleStatus(int result, int saleStatus)
     }
 }
 
+void GraftPOSClient::receiveSaleStatusDeadline()
+{
+    mStatusSubscription->unsubscribe(mPID);
+    emit saleStatusReceived(false);
+}
+
+void GraftPOSClient::receiveSubscribedSaleStatus(const QString &pid, int status)
+{
+    if (pid == mPID)
+    {
+        receiveSaleStatus(0, status);
+    }
+}
+
+void GraftPOSClient::retrySaleStatus()
+{
+    mStatusPoller->next(mPID);
+}
+
 void GraftPOSClient::initProductModels()
 {
+    const QString catalogPath = modelFilePath(scProductCatalogFile);
+    if (!QFileInfo::exists(catalogPath))
+    {
+        migrateProductList(catalogPath);
+    }
     mProductModel = new ProductModel(this);
-    ProductModelSerializator::deserialize(loadModel(scProductModelDataFile), mProductModel);
+    ProductStore *store = nullptr;
+#ifdef SQL_PRODUCT_CATALOG
+    store = openCatalogDatabase(catalogPath);
+#endif
+    if (!store)
+    {
+        // Only the journals are read here, products are read from the snapshot page by page as
+        // the lists show them.
+        ProductJournal *journal = new ProductJournal(catalogPath);
+        journal->load();
+        store = journal;
+    }
+    mProductModel->setStore(store);
     mSelectedProductModel = new SelectedProductProxyModel(this);
     mSelectedProductModel->setSourceModel(mProductModel);
+    mProductSearchModel = new ProductSearchModel(this);
+    mProductSearchModel->setSourceModel(mProductModel);
+}
+
+void GraftPOSClient::migrateProductList(const QString &catalogPath) const
+{
+    // Catalogs saved before the binary format are converted once, the JSON file is removed only
+    // after the binary catalog is committed.
+    QByteArray data = loadModel(scProductModelDataFile);
+    if (!data.isEmpty()
+            && BinaryProductStore::save(catalogPath,
+                                        ProductModelSerializator::deserializeItems(data)))
+    {
+        QFile::remove(modelFilePath(scProductModelDataFile));
+    }
+}
+
+#ifdef SQL_PRODUCT_CATALOG
+ProductStore *GraftPOSClient::openCatalogDatabase(const QString &catalogPath) const
+{
+    // The database is the catalog: it is filled once from a binary catalog left by an earlier
+    // version, which is removed after the import is committed.
+    QScopedPointer<SqlProductStore> database(
+                new SqlProductStore(modelFilePath(scProductDatabaseFile)));
+    if (!database->isValid())
+    {
+        return nullptr;
+    }
+    if (database->count() == 0 && QFileInfo::exists(catalogPath))
+    {
+        ProductJournal journal(catalogPath);
+        journal.load();
+        if (database->replace(journal.read(0, journal.count())))
+        {
+            journal.removeFiles();
+        }
+    }
+    return database.take();
 }
+#endif
 
 void GraftPOSClient::updateBalance()
 {
-    mApi->getBalance();
+    mApiThread->invoke([this] { mApi->getBalance(); });
 }
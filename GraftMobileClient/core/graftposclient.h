@@ -5,6 +5,10 @@
 #include <QVariant>
 
 class SelectedProductProxyModel;
+class ProductSearchModel;
+class ProductStore;
+class StatusSubscription;
+class StatusPoller;
 class ProductModel;
 class GraftPOSAPI;
 
@@ -19,6 +23,7 @@ public:
 
     ProductModel *productModel() const;
     SelectedProductProxyModel *selectedProductModel() const;
+    ProductSearchModel *productSearchModel() const;
 
     void registerTypes(QQmlEngine *engine) override;
     Q_INVOKABLE bool resetUrl(const QString &ip, const QString &port) override;
@@ -26,6 +31,11 @@ public:
     Q_INVOKABLE void createAccount(const QString &password) override;
     Q_INVOKABLE void restoreAccount(const QString &seed, const QString &password) override;
 
+#ifdef SQL_PRODUCT_CATALOG
+    Q_INVOKABLE void sortCatalog(int order, bool isAscending);
+    Q_INVOKABLE void filterCatalog(const QString &currency, const QString &name);
+#endif
+
 signals:
     void saleReceived(bool result);
     void rejectSaleReceived(bool result);
@@ -41,15 +51,25 @@ private slots:
     void receiveSale(int result, const QString &pid, int blockNum);
     void receiveRejectSale(int result);
     void receiveSaleStatus(int result, int saleStatus);
+    void receiveSaleStatusDeadline();
+    void receiveSubscribedSaleStatus(const QString &pid, int status);
+    void retrySaleStatus();
 
 private:
     void initProductModels();
+    void migrateProductList(const QString &catalogPath) const;
+#ifdef SQL_PRODUCT_CATALOG
+    ProductStore *openCatalogDatabase(const QString &catalogPath) const;
+#endif
     void updateBalance() override;
 
     GraftPOSAPI *mApi;
+    StatusPoller *mStatusPoller;
+    StatusSubscription *mStatusSubscription;
     QString mPID;
     ProductModel *mProductModel;
     SelectedProductProxyModel *mSelectedProductModel;
+    ProductSearchModel *mProductSearchModel;
 };
 
 #endif // GRAFTPOSCLIENT_H
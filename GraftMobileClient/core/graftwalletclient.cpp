@@ -1,6 +1,10 @@
 #include "productmodelserializator.h"
+#include "api/statussubscription.h"
+#include "api/graftapithread.h"
 #include "api/graftwalletapi.h"
 #include "graftwalletclient.h"
+#include "salepayload.h"
+#include "statuspoller.h"
 #include "accountmanager.h"
 #include "productmodel.h"
 #include "keygenerator.h"
@@ -10,7 +14,7 @@ GraftWalletClient::GraftWalletClient(QObject *parent)
     : GraftBaseClient(parent)
 {
     mBlockNum = 0;
-    mApi = new GraftWalletAPI(getServiceUrl(), dapiVersion(), this);
+    mApi = new GraftWalletAPI(getServiceUrl(), dapiVersion());
     connect(mApi, &GraftWalletAPI::getPOSDataReceived,
             this, &GraftWalletClient::receiveGetPOSData);
     connect(mApi, &GraftWalletAPI::rejectPayReceived, this, &GraftWalletClient::receiveRejectPay);
@@ -18,6 +22,20 @@ GraftWalletClient::GraftWalletClient(QObject *parent)
     connect(mApi, &GraftWalletAPI::getPayStatusReceived,
             this, &GraftWalletClient::receivePayStatus);
     connect(mApi, &GraftWalletAPI::error, this, &GraftWalletClient::errorReceived);
+    mStatusPoller = new StatusPoller(this);
+    connect(mStatusPoller, &StatusPoller::pollRequested, mApi, &GraftWalletAPI::getPayStatus);
+    connect(mStatusPoller, &StatusPoller::deadlineExpired,
+            this, &GraftWalletClient::receivePayStatusDeadline);
+    connect(mApi, &GraftWalletAPI::getPayStatusFailed,
+            this, &GraftWalletClient::retryPayStatus);
+    mStatusSubscription = new StatusSubscription(QStringLiteral("SubscribePayStatus"),
+                                                 dapiVersion(), this);
+    connect(mStatusSubscription, &StatusSubscription::subscribed,
+            mStatusPoller, &StatusPoller::suspend);
+    connect(mStatusSubscription, &StatusSubscription::failed,
+            mStatusPoller, &StatusPoller::resume);
+    connect(mStatusSubscription, &StatusSubscription::statusReceived,
+            this, &GraftWalletClient::receiveSubscribedPayStatus);
 
     mPaymentProductModel = new ProductModel(this);
     if (isAccountExists())
@@ -25,12 +43,17 @@ GraftWalletClient::GraftWalletClient(QObject *parent)
         mApi->setAccountData(mAccountManager->account(), mAccountManager->passsword());
     }
     registerBalanceTimer(mApi);
+    registerSupernodePool(mApi);
+    registerRequestStatistics(mApi);
+    mApiThread->attach(mApi);
 }
 
 void GraftWalletClient::setNetworkType(int networkType)
 {
     GraftBaseClient::setNetworkType(networkType);
-    mApi->setDAPIVersion(dapiVersion());
+    const QString version = dapiVersion();
+    mApiThread->invoke([this, version] { mApi->setDAPIVersion(version); });
+    mStatusSubscription->setDAPIVersion(dapiVersion());
 }
 
 double GraftWalletClient::totalCost() const
@@ -47,7 +70,11 @@ bool GraftWalletClient::resetUrl(const QString &ip, const QString &port)
 {
     if (GraftBaseClient::resetUrl(ip, port))
     {
-        mApi->setUrl(QUrl(scUrl.arg(QString("%1:%2").arg(ip).arg(port))));
+        const QUrl url(scUrl.arg(QString("%1:%2").arg(ip).arg(port)));
+        mApiThread->invoke([this, url] {
+            mApi->setSupernodePool(nullptr);
+            mApi->setUrl(url);
+        });
         return true;
     }
     return false;
@@ -67,15 +94,17 @@ void GraftWalletClient::getPOSData(const QString &data)
 {
     if (!data.isEmpty())
     {
-        QStringList dataList = data.split(';');
-        if (dataList.count() == 4)
+        const SalePayload payload = SalePayload::fromText(data);
+        if (payload.isValid())
         {
-            mPID = dataList.value(0);
-            mPrivateKey = dataList.value(1);
-            mTotalCost = dataList.value(2).toDouble();
-            mBlockNum = dataList.value(3).toInt();
+            mPID = payload.pid();
+            mPrivateKey = payload.address();
+            mTotalCost = payload.amount();
+            mBlockNum = payload.blockNumber();
             updateQuickExchange(mTotalCost);
-            mApi->getPOSData(mPID, mBlockNum);
+            const QString pid = mPID;
+            const int blockNum = mBlockNum;
+            mApiThread->invoke([this, pid, blockNum] { mApi->getPOSData(pid, blockNum); });
         }
         else
         {
@@ -86,25 +115,36 @@ void GraftWalletClient::getPOSData(const QString &data)
 
 void GraftWalletClient::rejectPay()
 {
-    mApi->rejectPay(mPID, mBlockNum);
+    mStatusPoller->cancel(mPID);
+    mStatusSubscription->unsubscribe(mPID);
+    const QString pid = mPID;
+    const int blockNum = mBlockNum;
+    mApiThread->invoke([this, pid, blockNum] { mApi->rejectPay(pid, blockNum); });
 }
 
 void GraftWalletClient::pay()
 {
-    mApi->pay(mPID, mPrivateKey, mTotalCost, mBlockNum);
+    const QString pid = mPID;
+    const QString privateKey = mPrivateKey;
+    const double amount = mTotalCost;
+    const int blockNum = mBlockNum;
+    mApiThread->invoke([this, pid, privateKey, amount, blockNum] {
+        mApi->pay(pid, privateKey, amount, blockNum);
+    });
 }
 
 void GraftWalletClient::getPayStatus()
 {
-    mApi->getPayStatus(mPID);
+    mStatusPoller->start(mPID);
+    mStatusSubscription->setUrl(getServiceUrl());
+    mStatusSubscription->subscribe(mPID);
 }
 
 void GraftWalletClient::receiveGetPOSData(int result, const QString &payDetails)
 {
     const bool isStatusOk = (result == 0);
-    mPaymentProductModel->clear();
     QByteArray data = QByteArray::fromHex(payDetails.toLatin1());
-    ProductModelSerializator::deserialize(data, mPaymentProductModel);
+    mPaymentProductModel->replace(ProductModelSerializator::deserializeItems(data));
     emit getPOSDataReceived(isStatusOk);
 }
 
@@ -125,12 +165,20 @@ void GraftWalletClient::receivePay(int result)
 
 void GraftWalletClient::receivePayStatus(int result, int payStatus)
 {
+    if (!mStatusPoller->isActive(mPID))
+    {
+        return;
+    }
+    if (result == 0 && payStatus == GraftWalletAPI::StatusProcessing)
+    {
+        mStatusPoller->next(mPID);
+        return;
+    }
+    mStatusPoller->stop(mPID);
+    mStatusSubscription->unsubscribe(mPID);
     if (result == 0)
     {
         switch (payStatus) {
-        case GraftWalletAPI::StatusProcessing:
-            getPayStatus();
-            break;
         case GraftWalletAPI::StatusApproved:
             emit payStatusReceived(true);
             break;
@@ -149,7 +197,26 @@ void GraftWalletClient::receivePayStatus(int result, int payStatus)
     }
 }
 
+void GraftWalletClient::receivePayStatusDeadline()
+{
+    mStatusSubscription->unsubscribe(mPID);
+    emit payStatusReceived(false);
+}
+
+void GraftWalletClient::receiveSubscribedPayStatus(const QString &pid, int status)
+{
+    if (pid == mPID)
+    {
+        receivePayStatus(0, status);
+    }
+}
+
+void GraftWalletClient::retryPayStatus()
+{
+    mStatusPoller->next(mPID);
+}
+
 void GraftWalletClient::updateBalance()
 {
-    mApi->getBalance();
+    mApiThread->invoke([this] { mApi->getBalance(); });
 }
@@ -4,6 +4,8 @@
 #include "graftbaseclient.h"
 
 class GraftWalletAPI;
+class StatusSubscription;
+class StatusPoller;
 class ProductModel;
 
 class GraftWalletClient : public GraftBaseClient
@@ -38,11 +40,16 @@ private slots:
     void receiveRejectPay(int result);
     void receivePay(int result);
     void receivePayStatus(int result, int payStatus);
+    void receivePayStatusDeadline();
+    void receiveSubscribedPayStatus(const QString &pid, int status);
+    void retryPayStatus();
 
 private:
     void updateBalance() override;
 
     GraftWalletAPI *mApi;
+    StatusPoller *mStatusPoller;
+    StatusSubscription *mStatusSubscription;
     QString mPID;
     QString mPrivateKey;
     int mBlockNum;
@@ -0,0 +1,154 @@
+#include "logger.h"
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QDateTime>
+#include <QVector>
+#include <QMutex>
+#include <QFile>
+#include <QDir>
+#include <cstdio>
+
+Q_LOGGING_CATEGORY(lcApi, "graft.api")
+Q_LOGGING_CATEGORY(lcSupernodes, "graft.supernodes")
+Q_LOGGING_CATEGORY(lcStatus, "graft.status")
+Q_LOGGING_CATEGORY(lcCatalog, "graft.catalog")
+Q_LOGGING_CATEGORY(lcImages, "graft.images")
+
+static const QString scCrashLogFile("crash.log");
+
+namespace {
+struct RingBuffer
+{
+    RingBuffer()
+        : next(0)
+        ,isFull(false)
+    {
+    }
+
+    QMutex mutex;
+    QVector<QString> lines;
+    int next;
+    bool isFull;
+};
+
+RingBuffer &ringBuffer()
+{
+    static RingBuffer buffer;
+    return buffer;
+}
+
+QtMessageHandler &previousHandler()
+{
+    static QtMessageHandler handler = nullptr;
+    return handler;
+}
+
+char levelTag(QtMsgType type)
+{
+    switch (type)
+    {
+    case QtDebugMsg:
+        return 'D';
+    case QtInfoMsg:
+        return 'I';
+    case QtWarningMsg:
+        return 'W';
+    case QtCriticalMsg:
+        return 'C';
+    case QtFatalMsg:
+        return 'F';
+    }
+    return '?';
+}
+}
+
+void Logger::install(int capacity)
+{
+    RingBuffer &buffer = ringBuffer();
+    {
+        QMutexLocker locker(&buffer.mutex);
+        buffer.lines = QVector<QString>(qMax(1, capacity));
+        buffer.next = 0;
+        buffer.isFull = false;
+    }
+    previousHandler() = qInstallMessageHandler(&Logger::handleMessage);
+}
+
+QStringList Logger::dump()
+{
+    RingBuffer &buffer = ringBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    QStringList lines;
+    if (buffer.isFull)
+    {
+        for (int i = buffer.next; i < buffer.lines.count(); ++i)
+        {
+            lines.append(buffer.lines.at(i));
+        }
+    }
+    for (int i = 0; i < buffer.next; ++i)
+    {
+        lines.append(buffer.lines.at(i));
+    }
+    return lines;
+}
+
+bool Logger::save(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+    {
+        return false;
+    }
+    QTextStream stream(&file);
+    for (const QString &line : dump())
+    {
+        stream << line << '\n';
+    }
+    return true;
+}
+
+QString Logger::redact(const QString &message)
+{
+    // Matches "Key":"value" pairs of the secret DAPI parameters both in raw JSON and in the
+    // escaped form QDebug prints QByteArrays in.
+    static const QRegularExpression scSecretPattern(
+                QStringLiteral("(\\\\?\"\\w*(?:Account|Seed|Password|Key)\\\\?\"\\s*:\\s*)"
+                               "(\\\\?\")(?:(?!\\2).)*\\2"));
+    QString redacted = message;
+    return redacted.replace(scSecretPattern, QStringLiteral("\\1\\2<redacted>\\2"));
+}
+
+void Logger::handleMessage(QtMsgType type, const QMessageLogContext &context,
+                           const QString &message)
+{
+    const QString redacted = redact(message);
+    const QString line = QString("%1 %2 %3: %4")
+            .arg(QTime::currentTime().toString(QStringLiteral("hh:mm:ss.zzz")))
+            .arg(QLatin1Char(levelTag(type)))
+            .arg(QLatin1String(context.category ? context.category : "default"))
+            .arg(redacted);
+    RingBuffer &buffer = ringBuffer();
+    {
+        QMutexLocker locker(&buffer.mutex);
+        buffer.lines[buffer.next] = line;
+        buffer.next = (buffer.next + 1) % buffer.lines.count();
+        buffer.isFull = buffer.isFull || buffer.next == 0;
+    }
+    if (type == QtFatalMsg)
+    {
+        QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dataPath);
+        save(QDir(dataPath).filePath(scCrashLogFile));
+    }
+    if (previousHandler())
+    {
+        previousHandler()(type, context, redacted);
+    }
+    else
+    {
+        fprintf(stderr, "%s\n", qPrintable(line));
+    }
+}
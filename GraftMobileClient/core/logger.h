@@ -0,0 +1,27 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <QLoggingCategory>
+#include <QStringList>
+
+Q_DECLARE_LOGGING_CATEGORY(lcApi)
+Q_DECLARE_LOGGING_CATEGORY(lcSupernodes)
+Q_DECLARE_LOGGING_CATEGORY(lcStatus)
+Q_DECLARE_LOGGING_CATEGORY(lcCatalog)
+Q_DECLARE_LOGGING_CATEGORY(lcImages)
+
+class Logger
+{
+public:
+    static void install(int capacity = 512);
+
+    static QStringList dump();
+    static bool save(const QString &fileName);
+    static QString redact(const QString &message);
+
+private:
+    static void handleMessage(QtMsgType type, const QMessageLogContext &context,
+                              const QString &message);
+};
+
+#endif // LOGGER_H
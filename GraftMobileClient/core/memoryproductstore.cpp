@@ -0,0 +1,53 @@
+#include "memoryproductstore.h"
+
+#include <algorithm>
+
+MemoryProductStore::MemoryProductStore(const QVector<ProductItem> &items)
+    : mItems(items)
+{
+}
+
+int MemoryProductStore::count() const
+{
+    return mItems.count();
+}
+
+QVector<ProductItem> MemoryProductStore::read(int first, int count) const
+{
+    if (first < 0 || count <= 0)
+    {
+        return QVector<ProductItem>();
+    }
+    return mItems.mid(first, count);
+}
+
+bool MemoryProductStore::insert(int row, const QVector<ProductItem> &items)
+{
+    if (row < 0 || row > mItems.count())
+    {
+        return false;
+    }
+    mItems.insert(row, items.count(), ProductItem());
+    std::copy(items.constBegin(), items.constEnd(), mItems.begin() + row);
+    return true;
+}
+
+bool MemoryProductStore::update(int row, const ProductItem &item)
+{
+    if (row < 0 || row >= mItems.count())
+    {
+        return false;
+    }
+    mItems[row] = item;
+    return true;
+}
+
+bool MemoryProductStore::remove(int row, int count)
+{
+    if (row < 0 || count <= 0 || row + count > mItems.count())
+    {
+        return false;
+    }
+    mItems.remove(row, count);
+    return true;
+}
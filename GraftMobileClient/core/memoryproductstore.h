@@ -0,0 +1,21 @@
+#ifndef MEMORYPRODUCTSTORE_H
+#define MEMORYPRODUCTSTORE_H
+
+#include "productstore.h"
+
+class MemoryProductStore : public ProductStore
+{
+public:
+    explicit MemoryProductStore(const QVector<ProductItem> &items = QVector<ProductItem>());
+
+    int count() const override;
+    QVector<ProductItem> read(int first, int count) const override;
+    bool insert(int row, const QVector<ProductItem> &items) override;
+    bool update(int row, const ProductItem &item) override;
+    bool remove(int row, int count) override;
+
+private:
+    QVector<ProductItem> mItems;
+};
+
+#endif // MEMORYPRODUCTSTORE_H
@@ -0,0 +1,162 @@
+#include "pagedproductmodel.h"
+#include "productstore.h"
+#include "productmodel.h"
+
+static const int scDefaultPageSize = 50;
+static const int scDefaultMaxResidentPages = 8;
+
+PagedProductModel::PagedProductModel(QObject *parent)
+    : QAbstractListModel(parent)
+    ,mPageSize(scDefaultPageSize)
+    ,mMaxResidentPages(scDefaultMaxResidentPages)
+{
+}
+
+PagedProductModel::~PagedProductModel()
+{
+}
+
+void PagedProductModel::setStore(ProductStore *store)
+{
+    beginResetModel();
+    mStore.reset(store);
+    mPages.clear();
+    mPageOrder.clear();
+    resetRows();
+    endResetModel();
+}
+
+void PagedProductModel::reload()
+{
+    beginResetModel();
+    mPages.clear();
+    mPageOrder.clear();
+    resetRows();
+    endResetModel();
+}
+
+ProductStore *PagedProductModel::store() const
+{
+    return mStore.data();
+}
+
+void PagedProductModel::setPageSize(int pageSize)
+{
+    if (pageSize > 0 && mPageSize != pageSize)
+    {
+        mPageSize = pageSize;
+        mPages.clear();
+        mPageOrder.clear();
+    }
+}
+
+int PagedProductModel::pageSize() const
+{
+    return mPageSize;
+}
+
+void PagedProductModel::setMaxResidentPages(int count)
+{
+    mMaxResidentPages = qMax(1, count);
+}
+
+int PagedProductModel::maxResidentPages() const
+{
+    return mMaxResidentPages;
+}
+
+int PagedProductModel::residentPageCount() const
+{
+    return mPages.count();
+}
+
+int PagedProductModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return mStore ? mStore->count() : 0;
+}
+
+QVariant PagedProductModel::data(const QModelIndex &index, int role) const
+{
+    const ProductItem *productItem = item(index.row());
+    if (!productItem)
+    {
+        return QVariant();
+    }
+    switch (role) {
+    case ProductModel::TitleRole:
+        return productItem->name();
+    case ProductModel::CostRole:
+        return productItem->cost();
+    case ProductModel::ImageRole:
+        return productItem->imagePath();
+    case ProductModel::SelectedRole:
+        return productItem->isSelected();
+    case ProductModel::CurrencyRole:
+        return productItem->currency();
+    case ProductModel::DescriptionRole:
+        return productItem->description();
+    case ProductModel::ThumbnailRole:
+        return productItem->thumbnailPath();
+    default:
+        return QVariant();
+    }
+}
+
+ProductItem PagedProductModel::product(int row) const
+{
+    const ProductItem *productItem = item(row);
+    return productItem ? *productItem : ProductItem();
+}
+
+QHash<int, QByteArray> PagedProductModel::roleNames() const
+{
+    return ProductModel::productRoleNames();
+}
+
+const ProductItem *PagedProductModel::item(int row) const
+{
+    if (!mStore || row < 0 || row >= mStore->count())
+    {
+        return nullptr;
+    }
+    const int page = row / mPageSize;
+    QHash<int, QVector<ProductItem>>::const_iterator it = mPages.constFind(page);
+    if (it == mPages.constEnd())
+    {
+        if (mPages.count() >= mMaxResidentPages)
+        {
+            mPages.remove(mPageOrder.takeFirst());
+        }
+        it = mPages.insert(page, mStore->read(page * mPageSize, mPageSize));
+        mPageOrder.append(page);
+    }
+    else if (mPageOrder.last() != page)
+    {
+        mPageOrder.removeOne(page);
+        mPageOrder.append(page);
+    }
+    const int offset = row - page * mPageSize;
+    return offset < it->count() ? &it->at(offset) : nullptr;
+}
+
+void PagedProductModel::invalidate(int first, int last)
+{
+    // Pages holding changed rows, or all rows from first on when last is negative, are read
+    // from the store again once they are needed.
+    const int firstPage = qMax(0, first) / mPageSize;
+    const int lastPage = last < 0 ? -1 : last / mPageSize;
+    for (int i = mPageOrder.count() - 1; i >= 0; --i)
+    {
+        const int page = mPageOrder.at(i);
+        if (page >= firstPage && (lastPage < 0 || page <= lastPage))
+        {
+            mPages.remove(page);
+            mPageOrder.remove(i);
+        }
+    }
+}
+
+void PagedProductModel::resetRows()
+{
+}
@@ -0,0 +1,49 @@
+#ifndef PAGEDPRODUCTMODEL_H
+#define PAGEDPRODUCTMODEL_H
+
+#include "productitem.h"
+#include <QAbstractListModel>
+#include <QScopedPointer>
+#include <QVector>
+#include <QHash>
+
+class ProductStore;
+
+class PagedProductModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit PagedProductModel(QObject *parent = nullptr);
+    ~PagedProductModel();
+
+    void setStore(ProductStore *store);
+    ProductStore *store() const;
+    void reload();
+
+    void setPageSize(int pageSize);
+    int pageSize() const;
+
+    void setMaxResidentPages(int count);
+    int maxResidentPages() const;
+    int residentPageCount() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    ProductItem product(int row) const;
+
+protected:
+    QHash<int, QByteArray> roleNames() const override;
+    const ProductItem *item(int row) const;
+    void invalidate(int first, int last = -1);
+    virtual void resetRows();
+
+private:
+    QScopedPointer<ProductStore> mStore;
+    int mPageSize;
+    int mMaxResidentPages;
+    mutable QHash<int, QVector<ProductItem>> mPages;
+    // Resident pages from the least to the most recently used one.
+    mutable QVector<int> mPageOrder;
+};
+
+#endif // PAGEDPRODUCTMODEL_H
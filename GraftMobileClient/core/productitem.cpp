@@ -5,17 +5,47 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QMutex>
+#include <QSet>
+
+static const int scMaxInternedCurrencies = 64;
+
+namespace {
+// Items are built by every store, on the GUI and the compaction threads. A catalog uses a handful
+// of currency codes, so the items share one string per code instead of one per item.
+QString internCurrency(const QString &currency)
+{
+    static QMutex mutex;
+    static QSet<QString> currencies;
+    QMutexLocker locker(&mutex);
+    QSet<QString>::const_iterator it = currencies.constFind(currency);
+    if (it != currencies.constEnd())
+    {
+        return *it;
+    }
+    if (currencies.count() < scMaxInternedCurrencies)
+    {
+        currencies.insert(currency);
+    }
+    return currency;
+}
+}
+
+ProductItem::ProductItem()
+    : mCost(0),
+      mSelected(false)
+{
+}
 
 ProductItem::ProductItem(const QString &imagePath, const QString &name, double cost,
                          const QString &currency, const QString &description)
-    : mImagePath(imagePath),
+    : mImagePath(QFileInfo(imagePath).fileName()),
       mName(name),
       mCost(cost),
       mSelected(false),
-      mCurrency(currency),
+      mCurrency(internCurrency(currency)),
       mDescription(description)
 {
-    setImagePath(imagePath);
 }
 
 QString ProductItem::imagePath() const
@@ -29,6 +59,20 @@ QString ProductItem::imagePath() const
     return QString();
 }
 
+QString ProductItem::imageName() const
+{
+    return mImagePath;
+}
+
+QString ProductItem::thumbnailPath() const
+{
+    if (!mImagePath.isEmpty())
+    {
+        return QStringLiteral("image://%1/%2").arg(scThumbnailImageProviderID).arg(mImagePath);
+    }
+    return QString();
+}
+
 QString ProductItem::name() const
 {
     return mName;
@@ -86,7 +130,7 @@ void ProductItem::setSelected(bool selected)
 
 void ProductItem::setCurrency(const QString &currency)
 {
-    mCurrency = currency;
+    mCurrency = internCurrency(currency);
 }
 
 void ProductItem::setDescription(const QString &description)
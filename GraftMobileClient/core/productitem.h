@@ -6,9 +6,12 @@
 class ProductItem
 {
 public:
+    ProductItem();
     ProductItem(const QString &imagePath, const QString &name, double cost,
                 const QString &currency, const QString &description);
     QString imagePath() const;
+    QString imageName() const;
+    QString thumbnailPath() const;
     QString name() const;
     double cost() const;
     bool isSelected() const;
@@ -33,4 +36,6 @@ private:
     QString mDescription;
 };
 
+Q_DECLARE_TYPEINFO(ProductItem, Q_MOVABLE_TYPE);
+
 #endif // PRODUCTITEM_H
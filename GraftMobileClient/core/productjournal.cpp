@@ -0,0 +1,430 @@
+#include "productjournal.h"
+#include "binaryproductstore.h"
+#include "logger.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QDir>
+
+// Every record is framed as quint32 payload size, quint16 qChecksum of the payload and the
+// payload itself, so a record torn by a power loss ends the replay instead of corrupting it.
+static const int scFrameSize = 6;
+static const int scCompactionRecordCount = 512;
+static const QString scJournalSuffix(".journal.%1");
+
+class ProductJournal::Snapshot : public QRunnable
+{
+public:
+    Snapshot(const ProductJournal *journal, const QSharedPointer<BinaryProductStore> &snapshot,
+             const QVector<Piece> &pieces, const QVector<ProductItem> &items, int count,
+             quint32 generation)
+        : mJournal(journal)
+        ,mSnapshot(snapshot)
+        ,mPieces(pieces)
+        ,mItems(items)
+        ,mCount(count)
+        ,mGeneration(generation)
+    {
+    }
+
+    void run() override
+    {
+        // The snapshot holds everything journaled before mGeneration, so the older journals are
+        // removed only once it is committed. A crash in between leaves journals that the
+        // generation stored in the snapshot tells load() to skip.
+        const QVector<ProductItem> items = ProductJournal::read(mSnapshot.data(), mPieces,
+                                                                mItems, 0, mCount);
+        if (BinaryProductStore::save(mJournal->catalogPath(), items, mGeneration))
+        {
+            for (quint32 generation : mJournal->journalGenerations())
+            {
+                if (generation < mGeneration)
+                {
+                    QFile::remove(mJournal->journalPath(generation));
+                }
+            }
+        }
+        else
+        {
+            qCWarning(lcCatalog) << "Catalog snapshot couldn't be written to"
+                                 << mJournal->catalogPath();
+        }
+    }
+
+private:
+    const ProductJournal *mJournal;
+    // The previous snapshot stays mapped until the pieces taken from it are written out.
+    QSharedPointer<BinaryProductStore> mSnapshot;
+    QVector<Piece> mPieces;
+    QVector<ProductItem> mItems;
+    int mCount;
+    quint32 mGeneration;
+};
+
+ProductJournal::ProductJournal(const QString &catalogPath)
+    : mCatalogPath(catalogPath)
+    ,mCount(0)
+    ,mGeneration(0)
+    ,mRecordCount(0)
+    ,mIsCompactionDue(false)
+{
+    // A single compaction thread keeps snapshots in order.
+    mCompactionPool.setMaxThreadCount(1);
+}
+
+ProductJournal::~ProductJournal()
+{
+    flush();
+    mCompactionPool.waitForDone();
+}
+
+QString ProductJournal::catalogPath() const
+{
+    return mCatalogPath;
+}
+
+void ProductJournal::load()
+{
+    mSnapshot.reset(new BinaryProductStore(mCatalogPath));
+    mPieces.clear();
+    mItems.clear();
+    mCount = mSnapshot->count();
+    if (mCount > 0)
+    {
+        const Piece piece = {true, 0, mCount};
+        mPieces.append(piece);
+    }
+    int replayed = 0;
+    bool isIntact = true;
+    quint32 generation = mSnapshot->generation();
+    for (quint32 journalGeneration : journalGenerations())
+    {
+        if (journalGeneration < mSnapshot->generation())
+        {
+            QFile::remove(journalPath(journalGeneration));
+            continue;
+        }
+        bool isJournalIntact = true;
+        replayed += replay(journalGeneration, &isJournalIntact);
+        isIntact = isIntact && isJournalIntact;
+        generation = qMax(generation, journalGeneration);
+    }
+    // Records appended after torn bytes would never be replayed, a journal that couldn't be cut
+    // back to its last good record is never written to again.
+    if (replayed > 0 || !isIntact)
+    {
+        openJournal(generation + 1);
+        writeSnapshot();
+    }
+    else
+    {
+        openJournal(generation);
+    }
+}
+
+void ProductJournal::compact()
+{
+    if (mRecordCount > 0)
+    {
+        openJournal(mGeneration + 1);
+        writeSnapshot();
+    }
+}
+
+void ProductJournal::removeFiles()
+{
+    mCompactionPool.waitForDone();
+    mJournal.close();
+    for (quint32 generation : journalGenerations())
+    {
+        QFile::remove(journalPath(generation));
+    }
+    QFile::remove(mCatalogPath);
+}
+
+int ProductJournal::count() const
+{
+    return mCount;
+}
+
+QVector<ProductItem> ProductJournal::read(int first, int count) const
+{
+    return read(mSnapshot.data(), mPieces, mItems, first, count);
+}
+
+bool ProductJournal::insert(int row, const QVector<ProductItem> &items)
+{
+    if (row < 0 || row > mCount)
+    {
+        return false;
+    }
+    insertPiece(row, items);
+    for (int i = 0; i < items.count(); ++i)
+    {
+        append(InsertOperation, row + i, 1, items.at(i));
+    }
+    compactIfDue();
+    return true;
+}
+
+bool ProductJournal::update(int row, const ProductItem &item)
+{
+    if (row < 0 || row >= mCount)
+    {
+        return false;
+    }
+    removePieces(row, 1);
+    insertPiece(row, QVector<ProductItem>(1, item));
+    append(UpdateOperation, row, 1, item);
+    compactIfDue();
+    return true;
+}
+
+bool ProductJournal::remove(int row, int count)
+{
+    if (row < 0 || count <= 0 || row + count > mCount)
+    {
+        return false;
+    }
+    removePieces(row, count);
+    append(RemoveOperation, row, count, ProductItem());
+    compactIfDue();
+    return true;
+}
+
+void ProductJournal::flush()
+{
+    if (mJournal.isOpen())
+    {
+        mJournal.flush();
+    }
+}
+
+QVector<ProductItem> ProductJournal::read(const BinaryProductStore *snapshot,
+                                          const QVector<Piece> &pieces,
+                                          const QVector<ProductItem> &items, int first,
+                                          int count)
+{
+    QVector<ProductItem> result;
+    if (first < 0 || count <= 0)
+    {
+        return result;
+    }
+    result.reserve(count);
+    const int end = first + count;
+    int start = 0;
+    for (const Piece &piece : pieces)
+    {
+        if (start >= end)
+        {
+            break;
+        }
+        const int pieceEnd = start + piece.count;
+        if (pieceEnd > first)
+        {
+            const int offset = qMax(first, start) - start;
+            const int length = qMin(end, pieceEnd) - start - offset;
+            if (piece.isStored)
+            {
+                result += snapshot->read(piece.first + offset, length);
+            }
+            else
+            {
+                result += items.mid(piece.first + offset, length);
+            }
+        }
+        start = pieceEnd;
+    }
+    return result;
+}
+
+QString ProductJournal::journalPath(quint32 generation) const
+{
+    return mCatalogPath + scJournalSuffix.arg(generation);
+}
+
+QList<quint32> ProductJournal::journalGenerations() const
+{
+    QFileInfo catalog(mCatalogPath);
+    const QString prefix = catalog.fileName() + scJournalSuffix.arg(QString());
+    QList<quint32> generations;
+    for (const QString &fileName : catalog.dir().entryList(QStringList(prefix + '*'),
+                                                           QDir::Files))
+    {
+        bool isNumber = false;
+        const quint32 generation = fileName.mid(prefix.size()).toUInt(&isNumber);
+        if (isNumber)
+        {
+            generations.append(generation);
+        }
+    }
+    std::sort(generations.begin(), generations.end());
+    return generations;
+}
+
+int ProductJournal::replay(quint32 generation, bool *isIntact)
+{
+    *isIntact = true;
+    QFile file(journalPath(generation));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+    const QByteArray journal = file.readAll();
+    int records = 0;
+    int position = 0;
+    while (position + scFrameSize <= journal.size())
+    {
+        QDataStream frame(journal.mid(position, scFrameSize));
+        quint32 size = 0;
+        quint16 checksum = 0;
+        frame >> size >> checksum;
+        if (position + scFrameSize + qint64(size) > journal.size()
+                || qChecksum(journal.constData() + position + scFrameSize, size) != checksum)
+        {
+            break;
+        }
+        QDataStream in(journal.mid(position + scFrameSize, size));
+        quint8 operation = 0;
+        qint32 row = 0;
+        qint32 count = 0;
+        QString imageName, name, currency, description;
+        double cost = 0;
+        in >> operation >> row >> count >> imageName >> name >> cost >> currency >> description;
+        position += scFrameSize + size;
+        ++records;
+        const ProductItem item(imageName, name, cost, currency, description);
+        switch (operation)
+        {
+        case InsertOperation:
+            if (row >= 0 && row <= mCount)
+            {
+                insertPiece(row, QVector<ProductItem>(1, item));
+            }
+            break;
+        case RemoveOperation:
+            if (row >= 0 && count > 0 && row + count <= mCount)
+            {
+                removePieces(row, count);
+            }
+            break;
+        case UpdateOperation:
+            if (row >= 0 && row < mCount)
+            {
+                removePieces(row, 1);
+                insertPiece(row, QVector<ProductItem>(1, item));
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (position < journal.size())
+    {
+        // The torn tail is cut off, so records appended to the journal follow the last good one.
+        qCWarning(lcCatalog) << "Journal" << file.fileName() << "is truncated after"
+                             << records << "records.";
+        file.close();
+        *isIntact = file.resize(position);
+        if (!*isIntact)
+        {
+            qCWarning(lcCatalog) << "Journal" << file.fileName() << "couldn't be cut back:"
+                                 << file.errorString();
+        }
+    }
+    return records;
+}
+
+void ProductJournal::openJournal(quint32 generation)
+{
+    if (mJournal.isOpen())
+    {
+        mJournal.close();
+    }
+    mGeneration = generation;
+    mRecordCount = 0;
+    mIsCompactionDue = false;
+    mJournal.setFileName(journalPath(generation));
+    if (!mJournal.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qCWarning(lcCatalog) << "Journal" << mJournal.fileName() << "couldn't be opened.";
+    }
+}
+
+void ProductJournal::append(Operation operation, int row, int count, const ProductItem &item)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << quint8(operation) << qint32(row) << qint32(count) << item.imageName() << item.name()
+        << item.cost() << item.currency() << item.description();
+    QByteArray record;
+    QDataStream frame(&record, QIODevice::WriteOnly);
+    frame << quint32(payload.size()) << qChecksum(payload.constData(), payload.size());
+    record.append(payload);
+    mJournal.write(record);
+    mJournal.flush();
+    // A change of several rows is journaled as several records, the snapshot waits for all of
+    // them so it never holds half a change.
+    if (++mRecordCount >= scCompactionRecordCount)
+    {
+        mIsCompactionDue = true;
+    }
+}
+
+void ProductJournal::compactIfDue()
+{
+    if (mIsCompactionDue)
+    {
+        compact();
+    }
+}
+
+void ProductJournal::writeSnapshot()
+{
+    mCompactionPool.start(new Snapshot(this, mSnapshot, mPieces, mItems, mCount, mGeneration));
+}
+
+int ProductJournal::split(int row)
+{
+    // Returns the index of the piece that starts at row, the piece holding it is cut in two.
+    int start = 0;
+    for (int i = 0; i < mPieces.count(); ++i)
+    {
+        if (row == start)
+        {
+            return i;
+        }
+        const Piece piece = mPieces.at(i);
+        if (row < start + piece.count)
+        {
+            const int length = row - start;
+            const Piece tail = {piece.isStored, piece.first + length, piece.count - length};
+            mPieces[i].count = length;
+            mPieces.insert(i + 1, tail);
+            return i + 1;
+        }
+        start += piece.count;
+    }
+    return mPieces.count();
+}
+
+void ProductJournal::insertPiece(int row, const QVector<ProductItem> &items)
+{
+    if (items.isEmpty())
+    {
+        return;
+    }
+    const Piece piece = {false, mItems.count(), items.count()};
+    mPieces.insert(split(row), piece);
+    mItems += items;
+    mCount += items.count();
+}
+
+void ProductJournal::removePieces(int row, int count)
+{
+    const int first = split(row);
+    const int last = split(row + count);
+    mPieces.remove(first, last - first);
+    mCount -= count;
+}
@@ -0,0 +1,78 @@
+#ifndef PRODUCTJOURNAL_H
+#define PRODUCTJOURNAL_H
+
+#include "productstore.h"
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QFile>
+
+class BinaryProductStore;
+
+// The catalog as a binary snapshot and journals of the changes made since. Rows are pieces of
+// the memory mapped snapshot or of the items added since, nothing is decoded before it is read.
+class ProductJournal : public ProductStore
+{
+public:
+    explicit ProductJournal(const QString &catalogPath);
+    ~ProductJournal();
+
+    QString catalogPath() const;
+
+    void load();
+    void compact();
+    void removeFiles();
+
+    int count() const override;
+    QVector<ProductItem> read(int first, int count) const override;
+    bool insert(int row, const QVector<ProductItem> &items) override;
+    bool update(int row, const ProductItem &item) override;
+    bool remove(int row, int count) override;
+    void flush() override;
+
+private:
+    enum Operation
+    {
+        InsertOperation = 1,
+        RemoveOperation = 2,
+        UpdateOperation = 3
+    };
+
+    struct Piece
+    {
+        bool isStored;
+        int first;
+        int count;
+    };
+
+    class Snapshot;
+
+    static QVector<ProductItem> read(const BinaryProductStore *snapshot,
+                                     const QVector<Piece> &pieces,
+                                     const QVector<ProductItem> &items, int first, int count);
+
+    QString journalPath(quint32 generation) const;
+    QList<quint32> journalGenerations() const;
+    int replay(quint32 generation, bool *isIntact);
+    void openJournal(quint32 generation);
+    void append(Operation operation, int row, int count, const ProductItem &item);
+    void compactIfDue();
+    void writeSnapshot();
+
+    int split(int row);
+    void insertPiece(int row, const QVector<ProductItem> &items);
+    void removePieces(int row, int count);
+
+    QString mCatalogPath;
+    QSharedPointer<BinaryProductStore> mSnapshot;
+    QVector<Piece> mPieces;
+    // Items added or changed since the snapshot, pieces refer to them by index.
+    QVector<ProductItem> mItems;
+    int mCount;
+    QFile mJournal;
+    quint32 mGeneration;
+    int mRecordCount;
+    bool mIsCompactionDue;
+    QThreadPool mCompactionPool;
+};
+
+#endif // PRODUCTJOURNAL_H
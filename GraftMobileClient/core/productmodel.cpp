@@ -1,127 +1,128 @@
 #include "productmodel.h"
+#include "memoryproductstore.h"
 #include "productitem.h"
 
+#include <algorithm>
+
+namespace {
+int lowerBound(const QVector<int> &rows, int row)
+{
+    return static_cast<int>(std::lower_bound(rows.constBegin(), rows.constEnd(), row)
+                            - rows.constBegin());
+}
+}
+
 ProductModel::ProductModel(QObject *parent)
-    : QAbstractListModel(parent)
+    : PagedProductModel(parent)
     ,mQuickDealMode(false)
-{}
+    ,mTotalCost(0)
+    ,mSelectedProductCount(0)
+{
+    setStore(new MemoryProductStore());
+}
 
 ProductModel::~ProductModel()
 {
-    qDeleteAll(mProducts);
 }
 
 QVariant ProductModel::data(const QModelIndex &index, int role) const
 {
-    if (index.row() < 0 || index.row() >= mProducts.count())
+    if (role == SelectedRole && index.row() >= 0 && index.row() < rowCount())
     {
-        return QVariant();
+        return isSelected(index.row());
     }
+    return PagedProductModel::data(index, role);
+}
 
-    ProductItem *productItem = mProducts[index.row()];
-    Q_ASSERT(productItem);
-    switch (role) {
+bool ProductModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || !value.isValid() || data(index, role) == value)
+    {
+        return false;
+    }
+    const int row = index.row();
+    if (role == SelectedRole)
+    {
+        setSelected(row, value.toBool());
+        emit dataChanged(index, index, QVector<int>() << SelectedRole);
+        return true;
+    }
+    ProductItem item = product(row);
+    const double cost = item.cost();
+    switch (role)
+    {
     case TitleRole:
-        return productItem->name();
+        item.setName(value.toString());
+        break;
     case CostRole:
-        return productItem->cost();
+        item.setCost(value.toDouble());
+        break;
     case ImageRole:
-        return productItem->imagePath();
-    case SelectedRole:
-        return productItem->isSelected();
+        item.setImagePath(value.toString());
+        break;
     case CurrencyRole:
-        return productItem->currency();
+        item.setCurrency(value.toString());
+        break;
     case DescriptionRole:
-        return productItem->description();
+        item.setDescription(value.toString());
+        break;
     default:
-        return QVariant();
+        return false;
     }
-}
-
-bool ProductModel::setData(const QModelIndex &index, const QVariant &value, int role)
-{
-    if (index.isValid() && value.isValid() && data(index, role) != value)
+    if (!store()->update(row, item))
     {
-        switch (role)
-        {
-        case TitleRole:
-            mProducts[index.row()]->setName(value.toString());
-            break;
-        case CostRole:
-            mProducts[index.row()]->setCost(value.toDouble());
-            break;
-        case ImageRole:
-            mProducts[index.row()]->setImagePath(value.toString());
-            break;
-        case SelectedRole:
-            mProducts[index.row()]->setSelected(value.toBool());
-            break;
-        case CurrencyRole:
-            mProducts[index.row()]->setCurrency(value.toString());
-            break;
-        case DescriptionRole:
-            mProducts[index.row()]->setDescription(value.toString());
-            break;
-        default:
-            break;
-        }
-        emit dataChanged(index, index, QVector<int>() << role);
+        return false;
+    }
+    if (role == CostRole && isSelected(row))
+    {
+        updateTotals(item.cost() - cost, 0);
+    }
+    if (!store()->hasStableRows())
+    {
+        reload();
         return true;
     }
-    return false;
+    invalidate(row, row);
+    QVector<int> changeRole;
+    changeRole.append(role);
+    if (role == ImageRole)
+    {
+        changeRole.append(ThumbnailRole);
+    }
+    emit dataChanged(index, index, changeRole);
+    return true;
 }
 
-int ProductModel::rowCount(const QModelIndex &parent) const
+bool ProductModel::isSelected(int row) const
 {
-    Q_UNUSED(parent);
-    return mProducts.count();
+    return std::binary_search(mSelectedRows.constBegin(), mSelectedRows.constEnd(), row);
 }
 
-QVector<ProductItem *> ProductModel::products() const
+const QVector<int> &ProductModel::selectedRows() const
 {
-    return mProducts;
+    return mSelectedRows;
 }
 
 void ProductModel::changeSelection(int index)
 {
-    ProductItem* lProduct = mProducts.value(index);
-    if (lProduct)
+    if (index >= 0 && index < rowCount())
     {
-        lProduct->changeSelection();
+        setSelected(index, !isSelected(index));
         QVector<int> changeRole;
         changeRole.append(SelectedRole);
         QModelIndex modelIndex = this->index(index);
         emit dataChanged(modelIndex, modelIndex, changeRole);
-        emit selectedProductCountChanged(selectedProductCount());
     }
 }
 
 double ProductModel::totalCost() const
 {
-    double total = 0;
-    for (int i = 0; i < mProducts.count(); ++i)
-    {
-        ProductItem *item = mProducts.value(i);
-        if (item->isSelected())
-        {
-            total += item->cost();
-        }
-    }
-    return total;
+    return mTotalCost;
 }
 
 unsigned int ProductModel::selectedProductCount() const
 {
-    unsigned int count = 0;
-    for (int i = 0; i < mProducts.count(); ++i)
-    {
-        ProductItem *item = mProducts.value(i);
-        if (item->isSelected())
-        {
-            ++count;
-        }
-    }
-    return count;
+    return mSelectedProductCount;
 }
 
 QVariant ProductModel::productData(int index, int role) const
@@ -138,9 +139,7 @@ bool ProductModel::setProductData(int index, const QVariant &value, int role)
 
 void ProductModel::removeProduct(int index)
 {
-    beginRemoveRows(QModelIndex(), index, index);
-    delete mProducts.takeAt(index);
-    endRemoveRows();
+    removeProducts(index, 1);
 }
 
 void ProductModel::clearSelections()
@@ -149,41 +148,43 @@ void ProductModel::clearSelections()
     {
         removeSelectedProducts();
     }
-    else
+    else if (!mSelectedRows.isEmpty())
     {
-        for (int i = 0; i < mProducts.count(); ++i)
-        {
-            ProductItem *item = mProducts.value(i);
-            if (item->isSelected())
-            {
-                item->setSelected(false);
-                QVector<int> changeRole;
-                changeRole.append(SelectedRole);
-                QModelIndex modelIndex = this->index(i);
-                emit dataChanged(modelIndex, modelIndex, changeRole);
-            }
-        }
+        const int first = mSelectedRows.first();
+        const int last = mSelectedRows.last();
+        mSelectedRows.clear();
+        QVector<int> changeRole;
+        changeRole.append(SelectedRole);
+        emit dataChanged(index(first), index(last), changeRole);
     }
-    emit selectedProductCountChanged(0);
+    resetTotals();
 }
 
 void ProductModel::clear()
 {
-    beginRemoveRows(QModelIndex(), 0, mProducts.count());
-    qDeleteAll(mProducts);
-    mProducts.clear();
-    endRemoveRows();
+    replace(QVector<ProductItem>());
+}
+
+void ProductModel::append(const QVector<ProductItem> &items)
+{
+    insertProducts(rowCount(), items);
+}
+
+void ProductModel::replace(const QVector<ProductItem> &items)
+{
+    // The model then holds the items in memory, the reset starts with an empty selection.
+    setStore(new MemoryProductStore(items));
 }
 
 void ProductModel::add(const QString &imagePath, const QString &name, double cost,
                        const QString &currency, const QString &description)
 {
-    beginInsertRows(QModelIndex(), rowCount(), rowCount());
-    mProducts << (new ProductItem(imagePath, name, cost, currency, description));
-    endInsertRows();
+    insertProducts(rowCount(),
+                   QVector<ProductItem>(1, ProductItem(imagePath, name, cost, currency,
+                                                       description)));
 }
 
-QHash<int, QByteArray> ProductModel::roleNames() const
+QHash<int, QByteArray> ProductModel::productRoleNames()
 {
     QHash<int, QByteArray> roles;
     roles[TitleRole] = "name";
@@ -192,6 +193,7 @@ QHash<int, QByteArray> ProductModel::roleNames() const
     roles[SelectedRole] = "selected";
     roles[CurrencyRole] = "currency";
     roles[DescriptionRole] = "description";
+    roles[ThumbnailRole] = "thumbnailPath";
     return roles;
 }
 
@@ -215,16 +217,160 @@ void ProductModel::removeSelectedProducts()
 {
     if (quickDealMode())
     {
-        for (int i = 0; i < mProducts.count(); ++i)
+        // Runs of selected rows are removed from the back, so every range keeps its indices
+        // and each one costs a single beginRemoveRows()/endRemoveRows() and a single store
+        // change.
+        const QVector<int> rows = mSelectedRows;
+        int end = rows.count();
+        while (end > 0)
         {
-            if (mProducts.at(i)->isSelected())
+            int begin = end - 1;
+            while (begin > 0 && rows.at(begin - 1) == rows.at(begin) - 1)
             {
-                beginRemoveRows(QModelIndex(), i, i);
-                delete mProducts.takeAt(i);
-                endRemoveRows();
-                i--;
+                --begin;
             }
+            removeProducts(rows.at(begin), end - begin);
+            end = begin;
         }
         mQuickDealMode = false;
+        resetTotals();
+    }
+}
+
+void ProductModel::resetRows()
+{
+    // Rows of a reloaded store may hold other products, the selection starts over.
+    mSelectedRows.clear();
+    resetTotals();
+}
+
+bool ProductModel::insertProducts(int row, const QVector<ProductItem> &items)
+{
+    if (items.isEmpty() || row < 0 || row > rowCount())
+    {
+        return false;
+    }
+    if (!store()->hasStableRows())
+    {
+        const bool isInserted = store()->insert(row, items);
+        reload();
+        return isInserted;
+    }
+    beginInsertRows(QModelIndex(), row, row + items.count() - 1);
+    const bool isInserted = store()->insert(row, items);
+    if (isInserted)
+    {
+        invalidate(row);
+        for (int i = lowerBound(mSelectedRows, row); i < mSelectedRows.count(); ++i)
+        {
+            mSelectedRows[i] += items.count();
+        }
+    }
+    endInsertRows();
+    if (!isInserted)
+    {
+        reload();
+        return false;
+    }
+    for (int i = 0; i < items.count(); ++i)
+    {
+        if (items.at(i).isSelected())
+        {
+            changeSelection(row + i);
+        }
+    }
+    return true;
+}
+
+bool ProductModel::removeProducts(int row, int count)
+{
+    if (count <= 0 || row < 0 || row + count > rowCount())
+    {
+        return false;
+    }
+    if (!store()->hasStableRows())
+    {
+        const bool isRemoved = store()->remove(row, count);
+        reload();
+        return isRemoved;
+    }
+    const int begin = lowerBound(mSelectedRows, row);
+    const int end = lowerBound(mSelectedRows, row + count);
+    double costDelta = 0;
+    for (int i = begin; i < end; ++i)
+    {
+        costDelta -= product(mSelectedRows.at(i)).cost();
+    }
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    const bool isRemoved = store()->remove(row, count);
+    if (isRemoved)
+    {
+        invalidate(row);
+        for (int i = end; i < mSelectedRows.count(); ++i)
+        {
+            mSelectedRows[i] -= count;
+        }
+        mSelectedRows.remove(begin, end - begin);
+    }
+    endRemoveRows();
+    if (!isRemoved)
+    {
+        reload();
+        return false;
+    }
+    if (end > begin)
+    {
+        updateTotals(costDelta, begin - end);
+    }
+    return true;
+}
+
+void ProductModel::setSelected(int row, bool isSelected)
+{
+    const int position = lowerBound(mSelectedRows, row);
+    const bool isListed = position < mSelectedRows.count() && mSelectedRows.at(position) == row;
+    if (isSelected == isListed)
+    {
+        return;
+    }
+    const double cost = product(row).cost();
+    if (isSelected)
+    {
+        mSelectedRows.insert(position, row);
+        updateTotals(cost, 1);
+    }
+    else
+    {
+        mSelectedRows.remove(position);
+        updateTotals(-cost, -1);
+    }
+}
+
+void ProductModel::updateTotals(double costDelta, int countDelta)
+{
+    mSelectedProductCount += countDelta;
+    // The running sum is rebased whenever the selection empties, so rounding errors of the
+    // additions never outlive a sale.
+    mTotalCost = mSelectedProductCount > 0 ? mTotalCost + costDelta : 0;
+    if (countDelta != 0)
+    {
+        emit selectedProductCountChanged(mSelectedProductCount);
+    }
+    emit totalCostChanged(mTotalCost);
+}
+
+void ProductModel::resetTotals()
+{
+    const bool isCountChanged = mSelectedProductCount != 0;
+    const bool isCostChanged = mTotalCost != 0;
+    mSelectedProductCount = 0;
+    mTotalCost = 0;
+    if (isCountChanged)
+    {
+        emit selectedProductCountChanged(0);
+    }
+    if (isCostChanged)
+    {
+        emit totalCostChanged(0);
     }
 }
@@ -1,13 +1,14 @@
 #ifndef PRODUCTMODEL_H
 #define PRODUCTMODEL_H
 
-#include <QAbstractListModel>
+#include "pagedproductmodel.h"
 
-class ProductItem;
-
-class ProductModel : public QAbstractListModel
+class ProductModel : public PagedProductModel
 {
     Q_OBJECT
+    Q_PROPERTY(double totalCost READ totalCost NOTIFY totalCostChanged)
+    Q_PROPERTY(unsigned int selectedProductCount READ selectedProductCount
+               NOTIFY selectedProductCountChanged)
 public:
     enum ProductRoles {
         TitleRole = Qt::UserRole + 1,
@@ -15,7 +16,8 @@ public:
         ImageRole,
         SelectedRole,
         CurrencyRole,
-        DescriptionRole
+        DescriptionRole,
+        ThumbnailRole
     };
     Q_ENUM(ProductRoles)
 
@@ -24,33 +26,47 @@ public:
 
     QVariant data(const QModelIndex &index, int role) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role) override;
-    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
-    QVector<ProductItem *> products() const;
+    bool isSelected(int row) const;
+    const QVector<int> &selectedRows() const;
     Q_INVOKABLE void changeSelection(int index);
-    Q_INVOKABLE double totalCost() const;
-    Q_INVOKABLE unsigned int selectedProductCount() const;
+    double totalCost() const;
+    unsigned int selectedProductCount() const;
     Q_INVOKABLE QVariant productData(int index, int role) const;
     Q_INVOKABLE bool setProductData(int index, const QVariant &value, int role);
     Q_INVOKABLE void removeProduct(int index);
     Q_INVOKABLE void clearSelections();
     void clear();
+    void append(const QVector<ProductItem> &items);
+    void replace(const QVector<ProductItem> &items);
     bool quickDealMode() const;
     Q_INVOKABLE void setQuickDealMode(bool quickDealMode);
     Q_INVOKABLE int totalProductsCount() const;
     Q_INVOKABLE void removeSelectedProducts();
 
+    static QHash<int, QByteArray> productRoleNames();
+
 signals:
     void selectedProductCountChanged(unsigned int count);
+    void totalCostChanged(double totalCost);
 
 public slots:
     void add(const QString &imagePath, const QString &name, double cost,
              const QString &currency, const QString &description = QString());
 
 protected:
-    QHash<int, QByteArray> roleNames() const override;
+    void resetRows() override;
 
 private:
-    QVector<ProductItem*> mProducts;
+    bool insertProducts(int row, const QVector<ProductItem> &items);
+    bool removeProducts(int row, int count);
+    void setSelected(int row, bool isSelected);
+    void updateTotals(double costDelta, int countDelta);
+    void resetTotals();
+
+    // Selections aren't part of the catalog, the model keeps the selected rows sorted.
+    QVector<int> mSelectedRows;
     bool mQuickDealMode;
+    double mTotalCost;
+    unsigned int mSelectedProductCount;
 };
 #endif // PRODUCTMODEL_H
@@ -7,24 +7,34 @@
 #include <QJsonObject>
 #include <QJsonValue>
 
+namespace {
+QJsonObject toJson(const ProductItem &item)
+{
+    QJsonObject object;
+    object.insert(QStringLiteral("imagePath"), item.imagePath());
+    object.insert(QStringLiteral("title"), item.name());
+    object.insert(QStringLiteral("cost"), item.cost());
+    object.insert(QStringLiteral("currency"), item.currency());
+    return object;
+}
+}
+
 QByteArray ProductModelSerializator::serialize(ProductModel *model, bool selectedOnly)
 {
-    QVector<ProductItem*> items = model->products();
     QJsonArray array;
-
-    for (ProductItem* item : items)
+    if (selectedOnly)
     {
-        if (selectedOnly && !item->isSelected())
+        for (int row : model->selectedRows())
         {
-            continue;
+            array.append(toJson(model->product(row)));
+        }
+    }
+    else
+    {
+        for (int row = 0; row < model->rowCount(); ++row)
+        {
+            array.append(toJson(model->product(row)));
         }
-
-        QJsonObject object;
-        object.insert(QStringLiteral("imagePath"), item->imagePath());
-        object.insert(QStringLiteral("title"), item->name());
-        object.insert(QStringLiteral("cost"), item->cost());
-        object.insert(QStringLiteral("currency"), item->currency());
-        array.append(object);
     }
 
     QJsonDocument doc(array);
@@ -35,17 +45,29 @@ void ProductModelSerializator::deserialize(const QByteArray &array, ProductModel
 {
     Q_ASSERT(model);
     if (model && !array.isEmpty())
+    {
+        model->append(deserializeItems(array));
+    }
+}
+
+QVector<ProductItem> ProductModelSerializator::deserializeItems(const QByteArray &array)
+{
+    QVector<ProductItem> items;
+    if (!array.isEmpty())
     {
         QJsonDocument jsonDoc = QJsonDocument::fromJson(array);
         QJsonArray jsonArray = jsonDoc.array();
+        items.reserve(jsonArray.count());
 
         for(int i = 0; i < jsonArray.count(); ++i)
         {
             QJsonObject jsonObject = jsonArray.at(i).toObject();
-            model->add(jsonObject.value(QLatin1String("imagePath")).toString(),
-                       jsonObject.value(QLatin1String("title")).toString(),
-                       jsonObject.value(QLatin1String("cost")).toDouble(),
-                       jsonObject.value(QLatin1String("currency")).toString());
+            items.append(ProductItem(jsonObject.value(QLatin1String("imagePath")).toString(),
+                                     jsonObject.value(QLatin1String("title")).toString(),
+                                     jsonObject.value(QLatin1String("cost")).toDouble(),
+                                     jsonObject.value(QLatin1String("currency")).toString(),
+                                     QString()));
         }
     }
+    return items;
 }
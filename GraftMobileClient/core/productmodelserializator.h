@@ -2,14 +2,17 @@
 #define PRODUCTMODELSERIALIZATOR_H
 
 #include <QByteArray>
+#include <QVector>
 
 class ProductModel;
+class ProductItem;
 
 class ProductModelSerializator
 {
 public:
     static QByteArray serialize(ProductModel *model, bool selectedOnly = false);
     static void deserialize(const QByteArray &array, ProductModel *model);
+    static QVector<ProductItem> deserializeItems(const QByteArray &array);
 };
 
 #endif // PRODUCTMODELSERIALIZATOR_H
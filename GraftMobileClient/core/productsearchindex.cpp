@@ -0,0 +1,223 @@
+#include "productsearchindex.h"
+
+#include <algorithm>
+
+static const int scTrigramSize = 3;
+
+void ProductSearchIndex::insert(quint32 id, const QString &name, const QString &description)
+{
+    remove(id);
+    Document document;
+    document.name = name.toCaseFolded();
+    document.description = description.toCaseFolded();
+    document.words = words(document.name + QLatin1Char(' ') + document.description);
+    document.words.removeDuplicates();
+    for (const QString &word : document.words)
+    {
+        mWords[word].insert(id);
+        for (const QString &trigram : trigrams(word))
+        {
+            mTrigrams[trigram].insert(id);
+        }
+    }
+    mDocuments.insert(id, document);
+}
+
+void ProductSearchIndex::remove(quint32 id)
+{
+    QHash<quint32, Document>::iterator it = mDocuments.find(id);
+    if (it == mDocuments.end())
+    {
+        return;
+    }
+    for (const QString &word : it->words)
+    {
+        QMap<QString, QSet<quint32>>::iterator wordIt = mWords.find(word);
+        wordIt->remove(id);
+        if (wordIt->isEmpty())
+        {
+            mWords.erase(wordIt);
+        }
+        for (const QString &trigram : trigrams(word))
+        {
+            QHash<QString, QSet<quint32>>::iterator trigramIt = mTrigrams.find(trigram);
+            if (trigramIt != mTrigrams.end())
+            {
+                trigramIt->remove(id);
+                if (trigramIt->isEmpty())
+                {
+                    mTrigrams.erase(trigramIt);
+                }
+            }
+        }
+    }
+    mDocuments.erase(it);
+}
+
+void ProductSearchIndex::clear()
+{
+    mDocuments.clear();
+    mWords.clear();
+    mTrigrams.clear();
+}
+
+int ProductSearchIndex::count() const
+{
+    return mDocuments.count();
+}
+
+QVector<quint32> ProductSearchIndex::search(const QString &query, int limit) const
+{
+    const QStringList terms = words(query.toCaseFolded());
+    if (terms.isEmpty() || limit <= 0)
+    {
+        return QVector<quint32>();
+    }
+    // Every term has to match, so the candidates of the rarest term are narrowed by the others.
+    QVector<QSet<quint32>> termCandidates;
+    for (const QString &term : terms)
+    {
+        termCandidates.append(candidates(term));
+        if (termCandidates.last().isEmpty())
+        {
+            return QVector<quint32>();
+        }
+    }
+    std::sort(termCandidates.begin(), termCandidates.end(),
+              [](const QSet<quint32> &a, const QSet<quint32> &b) { return a.size() < b.size(); });
+    QSet<quint32> matches = termCandidates.first();
+    for (int i = 1; i < termCandidates.count() && !matches.isEmpty(); ++i)
+    {
+        matches.intersect(termCandidates.at(i));
+    }
+
+    struct Match
+    {
+        quint32 id;
+        double score;
+        int length;
+    };
+    QVector<Match> ranked;
+    ranked.reserve(matches.count());
+    for (quint32 id : matches)
+    {
+        const Document &document = *mDocuments.constFind(id);
+        double total = 0;
+        for (const QString &term : terms)
+        {
+            const double termScore = score(document, term);
+            if (termScore <= 0)
+            {
+                total = 0;
+                break;
+            }
+            total += termScore;
+        }
+        if (total > 0)
+        {
+            ranked.append({id, total, document.name.size()});
+        }
+    }
+    const int resultCount = qMin(limit, ranked.count());
+    std::partial_sort(ranked.begin(), ranked.begin() + resultCount, ranked.end(),
+                      [](const Match &a, const Match &b) {
+        if (a.score != b.score)
+        {
+            return a.score > b.score;
+        }
+        return a.length != b.length ? a.length < b.length : a.id < b.id;
+    });
+    QVector<quint32> result;
+    result.reserve(resultCount);
+    for (int i = 0; i < resultCount; ++i)
+    {
+        result.append(ranked.at(i).id);
+    }
+    return result;
+}
+
+QStringList ProductSearchIndex::words(const QString &text)
+{
+    QStringList result;
+    int start = -1;
+    for (int i = 0; i <= text.size(); ++i)
+    {
+        const bool isWordChar = i < text.size() && text.at(i).isLetterOrNumber();
+        if (isWordChar && start < 0)
+        {
+            start = i;
+        }
+        else if (!isWordChar && start >= 0)
+        {
+            result.append(text.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return result;
+}
+
+QVector<QString> ProductSearchIndex::trigrams(const QString &word)
+{
+    QVector<QString> result;
+    for (int i = 0; i + scTrigramSize <= word.size(); ++i)
+    {
+        result.append(word.mid(i, scTrigramSize));
+    }
+    return result;
+}
+
+QSet<quint32> ProductSearchIndex::candidates(const QString &term) const
+{
+    QSet<quint32> result;
+    if (term.size() < scTrigramSize)
+    {
+        for (QMap<QString, QSet<quint32>>::const_iterator it = mWords.lowerBound(term);
+             it != mWords.constEnd() && it.key().startsWith(term); ++it)
+        {
+            result.unite(it.value());
+        }
+        return result;
+    }
+    const QVector<QString> termTrigrams = trigrams(term);
+    QVector<const QSet<quint32> *> postings;
+    for (const QString &trigram : termTrigrams)
+    {
+        QHash<QString, QSet<quint32>>::const_iterator it = mTrigrams.constFind(trigram);
+        if (it == mTrigrams.constEnd())
+        {
+            return result;
+        }
+        postings.append(&it.value());
+    }
+    std::sort(postings.begin(), postings.end(),
+              [](const QSet<quint32> *a, const QSet<quint32> *b) { return a->size() < b->size(); });
+    result = *postings.first();
+    for (int i = 1; i < postings.count() && !result.isEmpty(); ++i)
+    {
+        result.intersect(*postings.at(i));
+    }
+    return result;
+}
+
+double ProductSearchIndex::score(const Document &document, const QString &term)
+{
+    // Name matches outrank description matches, and matches at the start of a word outrank
+    // matches inside one. Trigram candidates are verified here as well.
+    const int namePosition = document.name.indexOf(term);
+    if (namePosition == 0)
+    {
+        return 4.0;
+    }
+    if (namePosition > 0)
+    {
+        return document.name.at(namePosition - 1).isLetterOrNumber() ? 2.0 : 3.0;
+    }
+    const int descriptionPosition = document.description.indexOf(term);
+    if (descriptionPosition >= 0)
+    {
+        return descriptionPosition == 0
+                || !document.description.at(descriptionPosition - 1).isLetterOrNumber()
+                ? 1.5 : 1.0;
+    }
+    return 0.0;
+}
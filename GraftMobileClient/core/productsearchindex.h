@@ -0,0 +1,39 @@
+#ifndef PRODUCTSEARCHINDEX_H
+#define PRODUCTSEARCHINDEX_H
+
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+
+class ProductSearchIndex
+{
+public:
+    void insert(quint32 id, const QString &name, const QString &description);
+    void remove(quint32 id);
+    void clear();
+    int count() const;
+
+    QVector<quint32> search(const QString &query, int limit) const;
+
+private:
+    struct Document
+    {
+        QString name;
+        QString description;
+        QStringList words;
+    };
+
+    static QStringList words(const QString &text);
+    static QVector<QString> trigrams(const QString &word);
+    QSet<quint32> candidates(const QString &term) const;
+    static double score(const Document &document, const QString &term);
+
+    QHash<quint32, Document> mDocuments;
+    // Words shorter than a trigram are only found through the sorted word list.
+    QMap<QString, QSet<quint32>> mWords;
+    QHash<QString, QSet<quint32>> mTrigrams;
+};
+
+#endif // PRODUCTSEARCHINDEX_H
@@ -0,0 +1,406 @@
+#include "productsearchmodel.h"
+#include "productmodel.h"
+
+#include <QSet>
+
+static const int scDefaultLimit = 50;
+
+namespace {
+// Marks the longest run of old results whose new positions keep their order, the results on it
+// stay in place and only the others are removed or inserted.
+QVector<bool> keptResults(const QVector<int> &positions)
+{
+    QVector<int> tails;
+    QVector<int> previous(positions.count(), -1);
+    for (int i = 0; i < positions.count(); ++i)
+    {
+        if (positions.at(i) < 0)
+        {
+            continue;
+        }
+        int low = 0;
+        int high = tails.count();
+        while (low < high)
+        {
+            const int middle = (low + high) / 2;
+            if (positions.at(tails.at(middle)) < positions.at(i))
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        previous[i] = low > 0 ? tails.at(low - 1) : -1;
+        if (low == tails.count())
+        {
+            tails.append(i);
+        }
+        else
+        {
+            tails[low] = i;
+        }
+    }
+    QVector<bool> isKept(positions.count(), false);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = previous.at(i))
+    {
+        isKept[i] = true;
+    }
+    return isKept;
+}
+}
+
+ProductSearchModel::ProductSearchModel(QObject *parent)
+    : QAbstractListModel(parent)
+    ,mNextId(0)
+    ,mLimit(scDefaultLimit)
+    ,mIsFiltered(false)
+    ,mIsIndexed(false)
+{
+}
+
+void ProductSearchModel::setSourceModel(ProductModel *model)
+{
+    if (mSource)
+    {
+        disconnect(mSource, nullptr, this, nullptr);
+    }
+    mSource = model;
+    if (mSource)
+    {
+        connect(mSource, &ProductModel::dataChanged,
+                this, &ProductSearchModel::sourceDataChanged);
+        connect(mSource, &ProductModel::rowsInserted,
+                this, &ProductSearchModel::sourceRowsInserted);
+        connect(mSource, &ProductModel::rowsAboutToBeRemoved,
+                this, &ProductSearchModel::sourceRowsAboutToBeRemoved);
+        connect(mSource, &ProductModel::rowsRemoved,
+                this, &ProductSearchModel::sourceRowsRemoved);
+        connect(mSource, &ProductModel::modelReset, this, &ProductSearchModel::sourceReset);
+    }
+    sourceReset();
+}
+
+ProductModel *ProductSearchModel::sourceModel() const
+{
+    return mSource;
+}
+
+QString ProductSearchModel::query() const
+{
+    return mQuery;
+}
+
+void ProductSearchModel::setQuery(const QString &query)
+{
+    if (mQuery != query)
+    {
+        mQuery = query;
+        updateResults();
+        emit queryChanged();
+    }
+}
+
+int ProductSearchModel::limit() const
+{
+    return mLimit;
+}
+
+void ProductSearchModel::setLimit(int limit)
+{
+    if (mLimit != limit)
+    {
+        mLimit = limit;
+        updateResults();
+        emit limitChanged();
+    }
+}
+
+int ProductSearchModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return mIsFiltered ? mResults.count() : mIds.count();
+}
+
+QVariant ProductSearchModel::data(const QModelIndex &index, int role) const
+{
+    const int row = sourceRow(index.row());
+    if (role == SourceRowRole)
+    {
+        return row;
+    }
+    if (row >= 0 && mSource)
+    {
+        return mSource->data(mSource->index(row), role);
+    }
+    return QVariant();
+}
+
+int ProductSearchModel::sourceRow(int row) const
+{
+    if (row < 0 || row >= rowCount())
+    {
+        return -1;
+    }
+    return mRows.value(mIsFiltered ? mResults.at(row) : mIds.at(row), -1);
+}
+
+QHash<int, QByteArray> ProductSearchModel::roleNames() const
+{
+    QHash<int, QByteArray> roles = QAbstractListModel::roleNames();
+    if (mSource)
+    {
+        const QAbstractItemModel *source = mSource;
+        roles = source->roleNames();
+    }
+    roles.insert(SourceRowRole, "sourceRow");
+    return roles;
+}
+
+void ProductSearchModel::sourceDataChanged(const QModelIndex &topLeft,
+                                           const QModelIndex &bottomRight,
+                                           const QVector<int> &roles)
+{
+    if (roles.isEmpty() || roles.contains(ProductModel::TitleRole)
+            || roles.contains(ProductModel::DescriptionRole))
+    {
+        if (mIsIndexed)
+        {
+            for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+            {
+                indexRow(row);
+            }
+        }
+        updateResults();
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+    {
+        const int position = mIsFiltered ? mResultPositions.value(mIds.value(row), -1) : row;
+        if (position >= 0)
+        {
+            emit dataChanged(index(position), index(position), roles);
+        }
+    }
+}
+
+void ProductSearchModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    if (!mIsFiltered)
+    {
+        beginInsertRows(QModelIndex(), first, last);
+    }
+    mIds.insert(first, last - first + 1, 0);
+    for (int row = first; row <= last; ++row)
+    {
+        mIds[row] = mNextId++;
+        if (mIsIndexed)
+        {
+            indexRow(row);
+        }
+    }
+    updateRowPositions(first);
+    if (!mIsFiltered)
+    {
+        endInsertRows();
+    }
+    updateResults();
+    updateSourceRows(last + 1);
+}
+
+void ProductSearchModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first,
+                                                    int last)
+{
+    // The rows and results go while the source still has them, the rows that follow keep
+    // their old source rows until the source has removed its rows.
+    Q_UNUSED(parent);
+    if (!mIsFiltered)
+    {
+        beginRemoveRows(QModelIndex(), first, last);
+    }
+    for (int row = first; row <= last; ++row)
+    {
+        mIndex.remove(mIds.at(row));
+        mRows.remove(mIds.at(row));
+    }
+    mIds.remove(first, last - first + 1);
+    if (!mIsFiltered)
+    {
+        endRemoveRows();
+    }
+    updateResults();
+}
+
+void ProductSearchModel::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    Q_UNUSED(last);
+    updateRowPositions(first);
+    updateSourceRows(first);
+}
+
+void ProductSearchModel::sourceReset()
+{
+    beginResetModel();
+    mIndex.clear();
+    mIds.clear();
+    mRows.clear();
+    mIsIndexed = false;
+    if (mSource)
+    {
+        const int count = mSource->rowCount();
+        mIds.reserve(count);
+        mRows.reserve(count);
+        for (int row = 0; row < count; ++row)
+        {
+            mIds.append(mNextId++);
+        }
+        updateRowPositions(0);
+    }
+    mIsFiltered = !mQuery.trimmed().isEmpty();
+    setResults(search());
+    endResetModel();
+}
+
+void ProductSearchModel::indexRow(int row)
+{
+    const ProductItem item = mSource->product(row);
+    mIndex.insert(mIds.at(row), item.name(), item.description());
+}
+
+void ProductSearchModel::updateRowPositions(int first)
+{
+    for (int row = first; row < mIds.count(); ++row)
+    {
+        mRows.insert(mIds.at(row), row);
+    }
+}
+
+void ProductSearchModel::updateSourceRows(int first)
+{
+    // Source rows from first on have moved, only the rows showing them get a new sourceRow.
+    const QVector<int> roles(1, SourceRowRole);
+    if (!mIsFiltered)
+    {
+        if (first < mIds.count())
+        {
+            emit dataChanged(index(first), index(mIds.count() - 1), roles);
+        }
+        return;
+    }
+    int begin = -1;
+    for (int row = 0; row <= mResults.count(); ++row)
+    {
+        const bool isMoved = row < mResults.count() && mRows.value(mResults.at(row)) >= first;
+        if (isMoved && begin < 0)
+        {
+            begin = row;
+        }
+        else if (!isMoved && begin >= 0)
+        {
+            emit dataChanged(index(begin), index(row - 1), roles);
+            begin = -1;
+        }
+    }
+}
+
+void ProductSearchModel::updateResults()
+{
+    const bool isFiltered = !mQuery.trimmed().isEmpty();
+    if (isFiltered != mIsFiltered)
+    {
+        // Starting or ending a search swaps the whole catalog for the results or back.
+        beginResetModel();
+        mIsFiltered = isFiltered;
+        setResults(search());
+        endResetModel();
+    }
+    else if (mIsFiltered)
+    {
+        applyResults(search());
+    }
+}
+
+QVector<quint32> ProductSearchModel::search()
+{
+    if (!mIsFiltered)
+    {
+        return QVector<quint32>();
+    }
+    if (!mIsIndexed)
+    {
+        // The catalog is read in full for the first search only, not when it is loaded.
+        for (int row = 0; row < mIds.count(); ++row)
+        {
+            indexRow(row);
+        }
+        mIsIndexed = true;
+    }
+    return mIndex.search(mQuery, mLimit);
+}
+
+void ProductSearchModel::setResults(const QVector<quint32> &results)
+{
+    mResults = results;
+    mResultPositions.clear();
+    for (int i = 0; i < mResults.count(); ++i)
+    {
+        mResultPositions.insert(mResults.at(i), i);
+    }
+}
+
+void ProductSearchModel::applyResults(const QVector<quint32> &results)
+{
+    QHash<quint32, int> positions;
+    for (int i = 0; i < results.count(); ++i)
+    {
+        positions.insert(results.at(i), i);
+    }
+    QVector<int> oldPositions;
+    oldPositions.reserve(mResults.count());
+    for (quint32 id : mResults)
+    {
+        oldPositions.append(positions.value(id, -1));
+    }
+    const QVector<bool> isKept = keptResults(oldPositions);
+    QSet<quint32> keptIds;
+    int end = mResults.count();
+    while (end > 0)
+    {
+        if (isKept.at(end - 1))
+        {
+            keptIds.insert(mResults.at(--end));
+            continue;
+        }
+        int begin = end - 1;
+        while (begin > 0 && !isKept.at(begin - 1))
+        {
+            --begin;
+        }
+        beginRemoveRows(QModelIndex(), begin, end - 1);
+        mResults.remove(begin, end - begin);
+        endRemoveRows();
+        end = begin;
+    }
+    // The kept results are in their new order now, the new ones are inserted between them.
+    int row = 0;
+    while (row < results.count())
+    {
+        if (keptIds.contains(results.at(row)))
+        {
+            ++row;
+            continue;
+        }
+        int last = row;
+        while (last + 1 < results.count() && !keptIds.contains(results.at(last + 1)))
+        {
+            ++last;
+        }
+        beginInsertRows(QModelIndex(), row, last);
+        mResults = mResults.mid(0, row) + results.mid(row, last - row + 1) + mResults.mid(row);
+        endInsertRows();
+        row = last + 1;
+    }
+    setResults(results);
+}
@@ -0,0 +1,77 @@
+#ifndef PRODUCTSEARCHMODEL_H
+#define PRODUCTSEARCHMODEL_H
+
+#include "productsearchindex.h"
+#include <QAbstractListModel>
+#include <QPointer>
+
+class ProductModel;
+
+class ProductSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(int limit READ limit WRITE setLimit NOTIFY limitChanged)
+public:
+    enum SearchRoles {
+        // Row of the result in ProductModel, past the roles of ProductModel itself.
+        SourceRowRole = Qt::UserRole + 100
+    };
+    Q_ENUM(SearchRoles)
+
+    explicit ProductSearchModel(QObject *parent = nullptr);
+
+    void setSourceModel(ProductModel *model);
+    ProductModel *sourceModel() const;
+
+    QString query() const;
+    void setQuery(const QString &query);
+
+    int limit() const;
+    void setLimit(int limit);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    Q_INVOKABLE int sourceRow(int row) const;
+
+signals:
+    void queryChanged();
+    void limitChanged();
+
+protected:
+    QHash<int, QByteArray> roleNames() const override;
+
+private slots:
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                           const QVector<int> &roles);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceReset();
+
+private:
+    void indexRow(int row);
+    void updateRowPositions(int first);
+    void updateSourceRows(int first);
+    void updateResults();
+    QVector<quint32> search();
+    void setResults(const QVector<quint32> &results);
+    void applyResults(const QVector<quint32> &results);
+
+    QPointer<ProductModel> mSource;
+    ProductSearchIndex mIndex;
+    // Source rows move on inserts and removals, the index refers to them by stable ids.
+    QVector<quint32> mIds;
+    QHash<quint32, int> mRows;
+    quint32 mNextId;
+    QString mQuery;
+    int mLimit;
+    bool mIsFiltered;
+    bool mIsIndexed;
+    // Results of a search, an empty query lists the source rows as they are.
+    QVector<quint32> mResults;
+    QHash<quint32, int> mResultPositions;
+};
+
+#endif // PRODUCTSEARCHMODEL_H
@@ -0,0 +1,49 @@
+#ifndef PRODUCTSTORE_H
+#define PRODUCTSTORE_H
+
+#include "productitem.h"
+#include <QVector>
+
+class ProductStore
+{
+public:
+    virtual ~ProductStore() {}
+
+    virtual int count() const = 0;
+    virtual QVector<ProductItem> read(int first, int count) const = 0;
+
+    // Read only stores, such as a bare snapshot, refuse every change.
+    virtual bool insert(int row, const QVector<ProductItem> &items)
+    {
+        Q_UNUSED(row);
+        Q_UNUSED(items);
+        return false;
+    }
+
+    virtual bool update(int row, const ProductItem &item)
+    {
+        Q_UNUSED(row);
+        Q_UNUSED(item);
+        return false;
+    }
+
+    virtual bool remove(int row, int count)
+    {
+        Q_UNUSED(row);
+        Q_UNUSED(count);
+        return false;
+    }
+
+    // A store whose rows may move on their own after a change, such as a sorted view, returns
+    // false and its models reload instead of moving single rows.
+    virtual bool hasStableRows() const
+    {
+        return true;
+    }
+
+    virtual void flush()
+    {
+    }
+};
+
+#endif // PRODUCTSTORE_H
@@ -1,15 +1,100 @@
 #include "qrcodegenerator.h"
 #include "QrCoder.hpp"
 #include <QImage>
-#include <QDebug>
+
+#include <cstring>
+
+// The QR specification asks for a light margin four modules wide around the symbol.
+static const int scQuietZone = 4;
+static const uchar scDark = 0x00;
+static const uchar scLight = 0xff;
+
+namespace {
+// The module matrix is the only part of QrCoder the renderer needs, its accessors are kept
+// here so that a change of the bundled library touches a single place.
+int moduleCount(const qrcodegen::QrCoder &qrcode)
+{
+    return qrcode.size;
+}
+
+int version(const qrcodegen::QrCoder &qrcode)
+{
+    return qrcode.version;
+}
+
+bool isDark(const qrcodegen::QrCoder &qrcode, int x, int y)
+{
+    return qrcode.getModule(x, y) != 0;
+}
+
+const qrcodegen::QrCoder::Ecc &ecc(QRCodeGenerator::ErrorCorrection level)
+{
+    switch (level) {
+    case QRCodeGenerator::Low:
+        return qrcodegen::QrCoder::Ecc::LOW;
+    case QRCodeGenerator::Medium:
+        return qrcodegen::QrCoder::Ecc::MEDIUM;
+    case QRCodeGenerator::High:
+        return qrcodegen::QrCoder::Ecc::HIGH;
+    default:
+        return qrcodegen::QrCoder::Ecc::QUARTILE;
+    }
+}
+
+qrcodegen::QrCoder encodeText(const QByteArray &text, QRCodeGenerator::ErrorCorrection level)
+{
+    if (level != QRCodeGenerator::Adaptive)
+    {
+        return qrcodegen::QrCoder::encodeText(text.constData(), ecc(level));
+    }
+    // The lowest level gives the smallest symbol, the strongest level that still fits into a
+    // symbol of that version is used. The mask is picked by the library's penalty score.
+    const qrcodegen::QrCoder smallest = qrcodegen::QrCoder::encodeText(
+                text.constData(), ecc(QRCodeGenerator::Low));
+    for (QRCodeGenerator::ErrorCorrection candidateLevel :
+         {QRCodeGenerator::High, QRCodeGenerator::Quartile, QRCodeGenerator::Medium})
+    {
+        const qrcodegen::QrCoder candidate = qrcodegen::QrCoder::encodeText(
+                    text.constData(), ecc(candidateLevel));
+        if (version(candidate) == version(smallest))
+        {
+            return candidate;
+        }
+    }
+    return smallest;
+}
+}
 
 QRCodeGenerator::QRCodeGenerator()
 {
 }
 
-QImage QRCodeGenerator::encode(const QString &message)
+QImage QRCodeGenerator::encode(const QString &message, int size, ErrorCorrection level) const
 {
-    qrcodegen::QrCoder qrcode = qrcodegen::QrCoder::encodeText(message.toStdString().c_str(), qrcodegen::QrCoder::Ecc::QUARTILE);
-    QImage img = QImage::fromData(QByteArray::fromStdString(qrcode.toSvgString(2)));
-    return img.scaled(300, 300);
+    const qrcodegen::QrCoder qrcode = encodeText(message.toUtf8(), level);
+    // Every module is drawn as a square of whole pixels, so no edge is interpolated. The pixels
+    // left over by the integer scale widen the quiet zone and keep the image at the requested
+    // size.
+    const int modules = moduleCount(qrcode);
+    const int scale = qMax(1, size / (modules + 2 * scQuietZone));
+    const int imageSize = qMax(size, (modules + 2 * scQuietZone) * scale);
+    const int offset = (imageSize - modules * scale) / 2;
+    QImage image(imageSize, imageSize, QImage::Format_Grayscale8);
+    image.fill(scLight);
+    for (int y = 0; y < modules; ++y)
+    {
+        uchar *line = image.scanLine(offset + y * scale);
+        for (int x = 0; x < modules; ++x)
+        {
+            if (isDark(qrcode, x, y))
+            {
+                std::memset(line + offset + x * scale, scDark, scale);
+            }
+        }
+        for (int row = 1; row < scale; ++row)
+        {
+            std::memcpy(image.scanLine(offset + y * scale + row), line, imageSize);
+        }
+    }
+    return image;
 }
@@ -7,8 +7,17 @@
 class QRCodeGenerator
 {
 public:
+    enum ErrorCorrection {
+        Low,
+        Medium,
+        Quartile,
+        High,
+        Adaptive
+    };
+
     QRCodeGenerator();
-    QImage encode(const QString &message);
+    QImage encode(const QString &message, int size = 300,
+                  ErrorCorrection level = Quartile) const;
 };
 
 #endif // QRCODEGENERATOR_H
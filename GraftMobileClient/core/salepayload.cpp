@@ -0,0 +1,404 @@
+#include "salepayload.h"
+
+#include <QStringList>
+#include <QByteArray>
+#include <QUuid>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// The compact form is "GRAFT:" followed by base45 of a binary record, all of it within the QR
+// alphanumeric character set:
+//   quint8 version, quint8 flags,
+//   pid:     16 RFC 4122 bytes with UuidFlag, otherwise varint length and UTF-8,
+//   address: varint length and the base58 decoded bytes with Base58AddressFlag, otherwise
+//            varint length and UTF-8,
+//   amount:  quint8 decimal exponent and varint mantissa,
+//   block:   varint.
+// Varints are unsigned LEB128.
+static const QString scCompactPrefix("GRAFT:");
+static const quint8 scCompactVersion = 1;
+static const quint8 scUuidFlag = 0x01;
+static const quint8 scBase58AddressFlag = 0x02;
+static const int scMaxAmountExponent = 10;
+static const int scUuidSize = 16;
+static const char scBase45Alphabet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+static const char scBase58Alphabet[] =
+        "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+// Base58 as used for CryptoNote addresses: blocks of eight bytes become eleven characters, the
+// last partial block of n bytes becomes scBase58BlockSizes[n] characters.
+static const int scBase58BlockSizes[] = {0, 2, 3, 5, 6, 7, 9, 10, 11};
+static const int scBase58FullBlockSize = 8;
+static const int scBase58FullEncodedSize = 11;
+
+namespace {
+void writeVarint(QByteArray &data, quint64 value)
+{
+    while (value >= 0x80)
+    {
+        data.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data.append(char(value));
+}
+
+bool readVarint(const QByteArray &data, int &position, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; position < data.size() && shift < 64; shift += 7)
+    {
+        const quint8 byte = quint8(data.at(position++));
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool readBytes(const QByteArray &data, int &position, int count, QByteArray &bytes)
+{
+    if (count < 0 || position + count > data.size())
+    {
+        return false;
+    }
+    bytes = data.mid(position, count);
+    position += count;
+    return true;
+}
+
+bool readSizedBytes(const QByteArray &data, int &position, QByteArray &bytes)
+{
+    quint64 size = 0;
+    return readVarint(data, position, size) && size <= quint64(data.size())
+            && readBytes(data, position, int(size), bytes);
+}
+
+QString toBase45(const QByteArray &data)
+{
+    QString text;
+    text.reserve((data.size() + 1) / 2 * 3);
+    for (int i = 0; i < data.size(); i += 2)
+    {
+        if (i + 1 < data.size())
+        {
+            int value = quint8(data.at(i)) * 256 + quint8(data.at(i + 1));
+            for (int digit = 0; digit < 3; ++digit)
+            {
+                text.append(QLatin1Char(scBase45Alphabet[value % 45]));
+                value /= 45;
+            }
+        }
+        else
+        {
+            const int value = quint8(data.at(i));
+            text.append(QLatin1Char(scBase45Alphabet[value % 45]));
+            text.append(QLatin1Char(scBase45Alphabet[value / 45]));
+        }
+    }
+    return text;
+}
+
+bool fromBase45(const QString &text, QByteArray &data)
+{
+    if (text.size() % 3 == 1)
+    {
+        return false;
+    }
+    data.clear();
+    for (int i = 0; i < text.size(); i += 3)
+    {
+        const int digits = qMin(3, text.size() - i);
+        int value = 0;
+        int weight = 1;
+        for (int digit = 0; digit < digits; ++digit)
+        {
+            const char *found = text.at(i + digit).unicode() < 0x80
+                    ? strchr(scBase45Alphabet, text.at(i + digit).toLatin1()) : nullptr;
+            if (!found || !*found)
+            {
+                return false;
+            }
+            value += int(found - scBase45Alphabet) * weight;
+            weight *= 45;
+        }
+        if (digits == 3)
+        {
+            if (value > 0xffff)
+            {
+                return false;
+            }
+            data.append(char(value >> 8));
+            data.append(char(value & 0xff));
+        }
+        else
+        {
+            if (value > 0xff)
+            {
+                return false;
+            }
+            data.append(char(value));
+        }
+    }
+    return true;
+}
+
+QString toBase58(const QByteArray &data)
+{
+    QString text;
+    for (int i = 0; i < data.size(); i += scBase58FullBlockSize)
+    {
+        const int size = qMin(scBase58FullBlockSize, data.size() - i);
+        quint64 value = 0;
+        for (int byte = 0; byte < size; ++byte)
+        {
+            value = (value << 8) | quint8(data.at(i + byte));
+        }
+        QString block(scBase58BlockSizes[size], QLatin1Char(scBase58Alphabet[0]));
+        for (int digit = block.size() - 1; digit >= 0 && value > 0; --digit)
+        {
+            block[digit] = QLatin1Char(scBase58Alphabet[value % 58]);
+            value /= 58;
+        }
+        text.append(block);
+    }
+    return text;
+}
+
+bool fromBase58(const QString &text, QByteArray &data)
+{
+    data.clear();
+    for (int i = 0; i < text.size(); i += scBase58FullEncodedSize)
+    {
+        const int length = qMin(scBase58FullEncodedSize, text.size() - i);
+        const int *sizeEnd = scBase58BlockSizes + scBase58FullBlockSize + 1;
+        const int *sizeIt = std::find(scBase58BlockSizes + 1, sizeEnd, length);
+        if (sizeIt == sizeEnd)
+        {
+            return false;
+        }
+        const int size = int(sizeIt - scBase58BlockSizes);
+        quint64 value = 0;
+        for (int digit = 0; digit < length; ++digit)
+        {
+            const char *found = text.at(i + digit).unicode() < 0x80
+                    ? strchr(scBase58Alphabet, text.at(i + digit).toLatin1()) : nullptr;
+            if (!found || !*found)
+            {
+                return false;
+            }
+            const quint64 digitValue = quint64(found - scBase58Alphabet);
+            if (value > (std::numeric_limits<quint64>::max() - digitValue) / 58)
+            {
+                return false;
+            }
+            value = value * 58 + digitValue;
+        }
+        if (size < scBase58FullBlockSize && value >> (8 * size))
+        {
+            return false;
+        }
+        for (int byte = size - 1; byte >= 0; --byte)
+        {
+            data.append(char((value >> (8 * byte)) & 0xff));
+        }
+    }
+    return true;
+}
+
+void writeString(QByteArray &data, const QString &string)
+{
+    const QByteArray utf8 = string.toUtf8();
+    writeVarint(data, quint64(utf8.size()));
+    data.append(utf8);
+}
+
+bool isSameAmount(double a, double b)
+{
+    return a == b || qFuzzyCompare(a, b);
+}
+}
+
+SalePayload::SalePayload()
+    : mAmount(0)
+    ,mBlockNumber(0)
+    ,mIsValid(false)
+{
+}
+
+SalePayload::SalePayload(const QString &pid, const QString &address, double amount,
+                         int blockNumber)
+    : mPID(pid)
+    ,mAddress(address)
+    ,mAmount(amount)
+    ,mBlockNumber(blockNumber)
+    ,mIsValid(true)
+{
+}
+
+QString SalePayload::pid() const
+{
+    return mPID;
+}
+
+QString SalePayload::address() const
+{
+    return mAddress;
+}
+
+double SalePayload::amount() const
+{
+    return mAmount;
+}
+
+int SalePayload::blockNumber() const
+{
+    return mBlockNumber;
+}
+
+bool SalePayload::isValid() const
+{
+    return mIsValid;
+}
+
+QString SalePayload::toText() const
+{
+    return QString("%1;%2;%3;%4").arg(mPID).arg(mAddress).arg(mAmount).arg(mBlockNumber);
+}
+
+QString SalePayload::toCompactText() const
+{
+    if (!mIsValid || mBlockNumber < 0 || mAmount < 0)
+    {
+        return QString();
+    }
+    QByteArray data;
+    data.append(char(scCompactVersion));
+    quint8 flags = 0;
+    const QUuid uuid(mPID);
+    if (!uuid.isNull() && uuid.toString().mid(1, 36) == mPID)
+    {
+        flags |= scUuidFlag;
+    }
+    QByteArray addressBytes;
+    if (fromBase58(mAddress, addressBytes) && toBase58(addressBytes) == mAddress)
+    {
+        flags |= scBase58AddressFlag;
+    }
+    data.append(char(flags));
+    if (flags & scUuidFlag)
+    {
+        data.append(uuid.toRfc4122());
+    }
+    else
+    {
+        writeString(data, mPID);
+    }
+    if (flags & scBase58AddressFlag)
+    {
+        writeVarint(data, quint64(addressBytes.size()));
+        data.append(addressBytes);
+    }
+    else
+    {
+        writeString(data, mAddress);
+    }
+    // The amount is kept as the shortest decimal that reads back as the same double.
+    int exponent = 0;
+    double scale = 1;
+    while (exponent < scMaxAmountExponent && !isSameAmount(qRound64(mAmount * scale) / scale,
+                                                            mAmount))
+    {
+        ++exponent;
+        scale *= 10;
+    }
+    if (mAmount * scale >= double(std::numeric_limits<qint64>::max()))
+    {
+        return QString();
+    }
+    data.append(char(exponent));
+    writeVarint(data, quint64(qRound64(mAmount * scale)));
+    writeVarint(data, quint64(mBlockNumber));
+
+    const QString text = scCompactPrefix + toBase45(data);
+    const SalePayload decoded = fromCompactText(text);
+    if (!decoded.isValid() || decoded.pid() != mPID || decoded.address() != mAddress
+            || decoded.blockNumber() != mBlockNumber
+            || !isSameAmount(decoded.amount(), mAmount))
+    {
+        return QString();
+    }
+    return text;
+}
+
+SalePayload SalePayload::fromText(const QString &text)
+{
+    if (text.startsWith(scCompactPrefix))
+    {
+        return fromCompactText(text);
+    }
+    const QStringList fields = text.split(';');
+    if (fields.count() == 4)
+    {
+        return SalePayload(fields.value(0), fields.value(1), fields.value(2).toDouble(),
+                           fields.value(3).toInt());
+    }
+    return SalePayload();
+}
+
+SalePayload SalePayload::fromCompactText(const QString &text)
+{
+    QByteArray data;
+    if (!fromBase45(text.mid(scCompactPrefix.size()), data) || data.size() < 2
+            || quint8(data.at(0)) != scCompactVersion)
+    {
+        return SalePayload();
+    }
+    const quint8 flags = quint8(data.at(1));
+    int position = 2;
+    QByteArray bytes;
+    QString pid;
+    if (flags & scUuidFlag)
+    {
+        if (!readBytes(data, position, scUuidSize, bytes))
+        {
+            return SalePayload();
+        }
+        pid = QUuid::fromRfc4122(bytes).toString().mid(1, 36);
+    }
+    else
+    {
+        if (!readSizedBytes(data, position, bytes))
+        {
+            return SalePayload();
+        }
+        pid = QString::fromUtf8(bytes);
+    }
+    if (!readSizedBytes(data, position, bytes))
+    {
+        return SalePayload();
+    }
+    const QString address = flags & scBase58AddressFlag ? toBase58(bytes)
+                                                        : QString::fromUtf8(bytes);
+    quint64 mantissa = 0;
+    quint64 blockNumber = 0;
+    if (position >= data.size())
+    {
+        return SalePayload();
+    }
+    const int exponent = quint8(data.at(position++));
+    if (exponent > scMaxAmountExponent || !readVarint(data, position, mantissa)
+            || !readVarint(data, position, blockNumber)
+            || blockNumber > quint64(std::numeric_limits<int>::max()))
+    {
+        return SalePayload();
+    }
+    double scale = 1;
+    for (int i = 0; i < exponent; ++i)
+    {
+        scale *= 10;
+    }
+    return SalePayload(pid, address, mantissa / scale, int(blockNumber));
+}
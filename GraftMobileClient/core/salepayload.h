@@ -0,0 +1,33 @@
+#ifndef SALEPAYLOAD_H
+#define SALEPAYLOAD_H
+
+#include <QString>
+
+class SalePayload
+{
+public:
+    SalePayload();
+    SalePayload(const QString &pid, const QString &address, double amount, int blockNumber);
+
+    QString pid() const;
+    QString address() const;
+    double amount() const;
+    int blockNumber() const;
+    bool isValid() const;
+
+    QString toText() const;
+    QString toCompactText() const;
+
+    static SalePayload fromText(const QString &text);
+
+private:
+    static SalePayload fromCompactText(const QString &text);
+
+    QString mPID;
+    QString mAddress;
+    double mAmount;
+    int mBlockNumber;
+    bool mIsValid;
+};
+
+#endif // SALEPAYLOAD_H
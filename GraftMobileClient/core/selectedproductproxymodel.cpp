@@ -1,35 +1,237 @@
 #include "selectedproductproxymodel.h"
 #include "productmodel.h"
 
+#include <algorithm>
+
 SelectedProductProxyModel::SelectedProductProxyModel(QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void SelectedProductProxyModel::setSourceModel(ProductModel *model)
+{
+    beginResetModel();
+    if (mSource)
+    {
+        disconnect(mSource, nullptr, this, nullptr);
+    }
+    mSource = model;
+    if (mSource)
+    {
+        connect(mSource, &ProductModel::dataChanged,
+                this, &SelectedProductProxyModel::sourceDataChanged);
+        connect(mSource, &ProductModel::rowsInserted,
+                this, &SelectedProductProxyModel::sourceRowsInserted);
+        connect(mSource, &ProductModel::rowsAboutToBeRemoved,
+                this, &SelectedProductProxyModel::sourceRowsAboutToBeRemoved);
+        connect(mSource, &ProductModel::rowsRemoved,
+                this, &SelectedProductProxyModel::sourceRowsRemoved);
+        connect(mSource, &ProductModel::modelAboutToBeReset,
+                this, &SelectedProductProxyModel::sourceAboutToBeReset);
+        connect(mSource, &ProductModel::modelReset,
+                this, &SelectedProductProxyModel::sourceReset);
+    }
+    rebuild();
+    endResetModel();
+}
+
+ProductModel *SelectedProductProxyModel::sourceModel() const
+{
+    return mSource;
+}
+
+int SelectedProductProxyModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return mRows.count();
+}
+
+QVariant SelectedProductProxyModel::data(const QModelIndex &index, int role) const
+{
+    QModelIndex sourceIndex = mapToSource(index);
+    if (sourceIndex.isValid())
+    {
+        return mSource->data(sourceIndex, role);
+    }
+    return QVariant();
+}
+
+QModelIndex SelectedProductProxyModel::mapToSource(const QModelIndex &proxyIndex) const
 {
+    if (mSource && proxyIndex.isValid() && proxyIndex.row() < mRows.count())
+    {
+        return mSource->index(mRows.at(proxyIndex.row()));
+    }
+    return QModelIndex();
+}
+
+QModelIndex SelectedProductProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (sourceIndex.isValid())
+    {
+        const int row = lowerBound(sourceIndex.row());
+        if (row < mRows.count() && mRows.at(row) == sourceIndex.row())
+        {
+            return index(row);
+        }
+    }
+    return QModelIndex();
+}
+
+QHash<int, QByteArray> SelectedProductProxyModel::roleNames() const
+{
+    if(mSource)
+    {
+        const QAbstractItemModel *source = mSource;
+        return source->roleNames();
+    }
+
+    return QAbstractListModel::roleNames();
 }
 
-bool SelectedProductProxyModel::filterAcceptsRow(int source_row,
-                                                 const QModelIndex &source_parent) const
+void SelectedProductProxyModel::sourceDataChanged(const QModelIndex &topLeft,
+                                                  const QModelIndex &bottomRight,
+                                                  const QVector<int> &roles)
 {
-    if (sourceModel())
+    const int begin = lowerBound(topLeft.row());
+    const int end = lowerBound(bottomRight.row() + 1);
+    if (!roles.isEmpty() && !roles.contains(ProductModel::SelectedRole))
     {
-        QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
-        if (index.isValid())
+        if (end > begin)
         {
-            QVariant valueRole = index.data(ProductModel::SelectedRole);
-            if (valueRole.isValid())
+            emit dataChanged(index(begin), index(end - 1), roles);
+        }
+        return;
+    }
+    QVector<int> selected;
+    for (int sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); ++sourceRow)
+    {
+        if (isSelected(sourceRow))
+        {
+            selected.append(sourceRow);
+        }
+    }
+    if (selected == mRows.mid(begin, end - begin))
+    {
+        if (end > begin)
+        {
+            emit dataChanged(index(begin), index(end - 1), roles);
+        }
+    }
+    else if (selected.isEmpty())
+    {
+        beginRemoveRows(QModelIndex(), begin, end - 1);
+        mRows.remove(begin, end - begin);
+        endRemoveRows();
+    }
+    else if (end == begin)
+    {
+        beginInsertRows(QModelIndex(), begin, begin + selected.count() - 1);
+        mRows.insert(begin, selected.count(), 0);
+        std::copy(selected.constBegin(), selected.constEnd(), mRows.begin() + begin);
+        endInsertRows();
+    }
+    else
+    {
+        // Some rows of a wider span were selected and others unselected, such spans are rare
+        // enough to be updated one row at a time.
+        for (int sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); ++sourceRow)
+        {
+            const int row = lowerBound(sourceRow);
+            const bool isListed = row < mRows.count() && mRows.at(row) == sourceRow;
+            if (isSelected(sourceRow) && !isListed)
+            {
+                beginInsertRows(QModelIndex(), row, row);
+                mRows.insert(row, sourceRow);
+                endInsertRows();
+            }
+            else if (!isSelected(sourceRow) && isListed)
             {
-                return valueRole.toBool();
+                beginRemoveRows(QModelIndex(), row, row);
+                mRows.remove(row);
+                endRemoveRows();
             }
         }
     }
-    return false;
 }
 
-QHash<int, QByteArray> SelectedProductProxyModel::roleNames() const
+void SelectedProductProxyModel::sourceRowsInserted(const QModelIndex &parent, int first,
+                                                   int last)
 {
-    if(sourceModel())
+    Q_UNUSED(parent);
+    const int count = last - first + 1;
+    const int row = lowerBound(first);
+    for (int i = row; i < mRows.count(); ++i)
+    {
+        mRows[i] += count;
+    }
+    QVector<int> inserted;
+    for (int sourceRow = first; sourceRow <= last; ++sourceRow)
     {
-        return sourceModel()->roleNames();
+        if (isSelected(sourceRow))
+        {
+            inserted.append(sourceRow);
+        }
     }
+    if (!inserted.isEmpty())
+    {
+        beginInsertRows(QModelIndex(), row, row + inserted.count() - 1);
+        mRows.insert(row, inserted.count(), 0);
+        std::copy(inserted.constBegin(), inserted.constEnd(), mRows.begin() + row);
+        endInsertRows();
+    }
+}
 
-    return QSortFilterProxyModel::roleNames();
+void SelectedProductProxyModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first,
+                                                            int last)
+{
+    // The rows go while the source still has them, so views never see a proxy row whose
+    // product is already gone.
+    Q_UNUSED(parent);
+    const int begin = lowerBound(first);
+    const int end = lowerBound(last + 1);
+    if (end > begin)
+    {
+        beginRemoveRows(QModelIndex(), begin, end - 1);
+        mRows.remove(begin, end - begin);
+        endRemoveRows();
+    }
+}
+
+void SelectedProductProxyModel::sourceRowsRemoved(const QModelIndex &parent, int first,
+                                                  int last)
+{
+    Q_UNUSED(parent);
+    const int count = last - first + 1;
+    for (int i = lowerBound(first); i < mRows.count(); ++i)
+    {
+        mRows[i] -= count;
+    }
+}
+
+void SelectedProductProxyModel::sourceAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void SelectedProductProxyModel::sourceReset()
+{
+    rebuild();
+    endResetModel();
+}
+
+bool SelectedProductProxyModel::isSelected(int sourceRow) const
+{
+    return mSource->isSelected(sourceRow);
+}
+
+int SelectedProductProxyModel::lowerBound(int sourceRow) const
+{
+    return static_cast<int>(std::lower_bound(mRows.constBegin(), mRows.constEnd(), sourceRow)
+                            - mRows.constBegin());
+}
+
+void SelectedProductProxyModel::rebuild()
+{
+    mRows = mSource ? mSource->selectedRows() : QVector<int>();
 }
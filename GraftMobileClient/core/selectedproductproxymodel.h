@@ -1,18 +1,47 @@
 #ifndef SELECTEDPRODUCTPROXYMODEL_H
 #define SELECTEDPRODUCTPROXYMODEL_H
 
-#include <QSortFilterProxyModel>
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QVector>
 
-class SelectedProductProxyModel : public QSortFilterProxyModel
+class ProductModel;
+
+class SelectedProductProxyModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
     SelectedProductProxyModel(QObject *parent = nullptr);
 
-    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+    void setSourceModel(ProductModel *model);
+    ProductModel *sourceModel() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const;
 
 protected:
-    QHash<int, QByteArray> roleNames() const;
+    QHash<int, QByteArray> roleNames() const override;
+
+private slots:
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                           const QVector<int> &roles);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceAboutToBeReset();
+    void sourceReset();
+
+private:
+    bool isSelected(int sourceRow) const;
+    int lowerBound(int sourceRow) const;
+    void rebuild();
+
+    QPointer<ProductModel> mSource;
+    // Source rows of the selected products, kept sorted.
+    QVector<int> mRows;
 };
 
 #endif // SELECTEDPRODUCTPROXYMODEL_H
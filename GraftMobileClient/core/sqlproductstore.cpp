@@ -0,0 +1,399 @@
+#include "sqlproductstore.h"
+#include "logger.h"
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QVariant>
+
+static const QString scDriver("QSQLITE");
+static const QString scConnectionName("productCatalog-%1");
+// Positions only order the rows and leave room between them, so an insert takes a free position
+// instead of moving every row after it.
+static const qint64 scPositionStep = 1024;
+
+SqlProductStore::SqlProductStore(const QString &fileName)
+    : mConnectionName(scConnectionName.arg(reinterpret_cast<quintptr>(this)))
+    ,mIsValid(false)
+    ,mOrder(PositionOrder)
+    ,mSortOrder(Qt::AscendingOrder)
+    ,mCount(-1)
+{
+    QSqlDatabase database = QSqlDatabase::addDatabase(scDriver, mConnectionName);
+    database.setDatabaseName(fileName);
+    if (!database.open())
+    {
+        qCWarning(lcCatalog) << "Catalog database couldn't be opened:"
+                             << database.lastError().text();
+        return;
+    }
+    mIsValid = createSchema();
+    if (mIsValid)
+    {
+        mLastPositionQuery = QSqlQuery(database);
+        mLastPositionQuery.prepare("SELECT MAX(position) FROM products");
+        mShiftQuery = QSqlQuery(database);
+        mShiftQuery.prepare("UPDATE products SET position = position + :delta "
+                            "WHERE position >= :first");
+        mInsertQuery = QSqlQuery(database);
+        mInsertQuery.prepare("INSERT INTO products "
+                             "(position, image_name, name, cost, currency, description) "
+                             "VALUES (:position, :image_name, :name, :cost, :currency, "
+                             ":description)");
+        mRemoveQuery = QSqlQuery(database);
+        mRemoveQuery.prepare("DELETE FROM products WHERE id = :id");
+        mUpdateQuery = QSqlQuery(database);
+        mUpdateQuery.prepare("UPDATE products SET image_name = :image_name, name = :name, "
+                             "cost = :cost, currency = :currency, description = :description "
+                             "WHERE id = :id");
+        prepareView();
+    }
+}
+
+SqlProductStore::~SqlProductStore()
+{
+    // Queries have to be released before the connection can be removed.
+    mCountQuery = QSqlQuery();
+    mReadQuery = QSqlQuery();
+    mKeyQuery = QSqlQuery();
+    mLastPositionQuery = QSqlQuery();
+    mShiftQuery = QSqlQuery();
+    mInsertQuery = QSqlQuery();
+    mRemoveQuery = QSqlQuery();
+    mUpdateQuery = QSqlQuery();
+    QSqlDatabase::database(mConnectionName, false).close();
+    QSqlDatabase::removeDatabase(mConnectionName);
+}
+
+bool SqlProductStore::isValid() const
+{
+    return mIsValid;
+}
+
+int SqlProductStore::count() const
+{
+    if (mCount < 0 && mIsValid)
+    {
+        mCount = exec(mCountQuery) && mCountQuery.next() ? mCountQuery.value(0).toInt() : 0;
+        mCountQuery.finish();
+    }
+    return qMax(0, mCount);
+}
+
+QVector<ProductItem> SqlProductStore::read(int first, int count) const
+{
+    QVector<ProductItem> items;
+    if (!mIsValid || first < 0 || count <= 0)
+    {
+        return items;
+    }
+    mReadQuery.bindValue(":first", first);
+    mReadQuery.bindValue(":count", count);
+    if (exec(mReadQuery))
+    {
+        items.reserve(count);
+        while (mReadQuery.next())
+        {
+            items.append(ProductItem(mReadQuery.value(0).toString(),
+                                     mReadQuery.value(1).toString(),
+                                     mReadQuery.value(2).toDouble(),
+                                     mReadQuery.value(3).toString(),
+                                     mReadQuery.value(4).toString()));
+        }
+        mReadQuery.finish();
+    }
+    return items;
+}
+
+void SqlProductStore::setOrder(Order order, Qt::SortOrder sortOrder)
+{
+    if (mOrder != order || mSortOrder != sortOrder)
+    {
+        mOrder = order;
+        mSortOrder = sortOrder;
+        prepareView();
+    }
+}
+
+void SqlProductStore::setFilter(const QString &currency, const QString &name)
+{
+    if (mCurrency != currency || mName != name)
+    {
+        mCurrency = currency;
+        mName = name;
+        prepareView();
+    }
+}
+
+bool SqlProductStore::insert(int row, const QVector<ProductItem> &items)
+{
+    if (!mIsValid || items.isEmpty() || row < 0 || row > count())
+    {
+        return false;
+    }
+    QSqlDatabase database = QSqlDatabase::database(mConnectionName);
+    database.transaction();
+    const qint64 required = items.count() + 1;
+    qint64 low = 0;
+    qint64 high = 0;
+    bool isDone = true;
+    if (hasStableRows() && row < count())
+    {
+        low = row > 0 ? position(row - 1) : 0;
+        high = position(row);
+        isDone = low >= 0 && high >= 0;
+        if (isDone && high - low < required)
+        {
+            // The room before the row is used up, the rows from there on move once to make
+            // room for many more inserts.
+            mShiftQuery.bindValue(":delta", scPositionStep * required);
+            mShiftQuery.bindValue(":first", high);
+            isDone = exec(mShiftQuery);
+            high += scPositionStep * required;
+        }
+    }
+    else
+    {
+        // Rows past the end, and any row of a sorted or filtered view, follow the last one.
+        isDone = exec(mLastPositionQuery) && mLastPositionQuery.next();
+        low = isDone ? mLastPositionQuery.value(0).toLongLong() : 0;
+        mLastPositionQuery.finish();
+        high = low + scPositionStep * required;
+    }
+    for (int i = 0; isDone && i < items.count(); ++i)
+    {
+        isDone = insertAt(low + (high - low) * (i + 1) / required, items.at(i));
+    }
+    mCount = -1;
+    if (isDone)
+    {
+        return database.commit();
+    }
+    database.rollback();
+    return false;
+}
+
+bool SqlProductStore::update(int row, const ProductItem &item)
+{
+    if (!mIsValid)
+    {
+        return false;
+    }
+    const QVector<qint64> rowIds = ids(row, 1);
+    if (rowIds.isEmpty())
+    {
+        return false;
+    }
+    mUpdateQuery.bindValue(":id", rowIds.first());
+    bindItem(mUpdateQuery, item);
+    mCount = -1;
+    return exec(mUpdateQuery);
+}
+
+bool SqlProductStore::remove(int row, int count)
+{
+    if (!mIsValid || count <= 0)
+    {
+        return false;
+    }
+    const QVector<qint64> rowIds = ids(row, count);
+    if (rowIds.count() != count)
+    {
+        return false;
+    }
+    QSqlDatabase database = QSqlDatabase::database(mConnectionName);
+    database.transaction();
+    mCount = -1;
+    bool isDone = true;
+    for (int i = 0; isDone && i < rowIds.count(); ++i)
+    {
+        mRemoveQuery.bindValue(":id", rowIds.at(i));
+        isDone = exec(mRemoveQuery);
+    }
+    if (isDone)
+    {
+        return database.commit();
+    }
+    database.rollback();
+    return false;
+}
+
+bool SqlProductStore::hasStableRows() const
+{
+    return mOrder == PositionOrder && mCurrency.isEmpty() && mName.isEmpty();
+}
+
+bool SqlProductStore::replace(const QVector<ProductItem> &items)
+{
+    if (!mIsValid)
+    {
+        return false;
+    }
+    QSqlDatabase database = QSqlDatabase::database(mConnectionName);
+    database.transaction();
+    QSqlQuery clearQuery(database);
+    mCount = -1;
+    bool isDone = clearQuery.exec("DELETE FROM products");
+    for (int row = 0; isDone && row < items.count(); ++row)
+    {
+        isDone = insertAt(scPositionStep * (row + 1), items.at(row));
+    }
+    if (isDone)
+    {
+        return database.commit();
+    }
+    database.rollback();
+    return false;
+}
+
+bool SqlProductStore::createSchema()
+{
+    // WAL keeps single row edits to an append to the log instead of a rewrite of the pages and
+    // lets readers run during a write. NOCASE on the name column lets prefix LIKE filters use
+    // its index.
+    QSqlQuery query(QSqlDatabase::database(mConnectionName));
+    const QStringList statements = {
+        "PRAGMA journal_mode = WAL",
+        "PRAGMA synchronous = NORMAL",
+        "CREATE TABLE IF NOT EXISTS products (id INTEGER PRIMARY KEY, position INTEGER NOT NULL, "
+        "image_name TEXT, name TEXT COLLATE NOCASE, cost REAL, currency TEXT, description TEXT)",
+        "CREATE INDEX IF NOT EXISTS products_position ON products (position)",
+        "CREATE INDEX IF NOT EXISTS products_name ON products (name)",
+        "CREATE INDEX IF NOT EXISTS products_currency ON products (currency, position)",
+        "CREATE INDEX IF NOT EXISTS products_cost ON products (cost)"
+    };
+    for (const QString &statement : statements)
+    {
+        if (!query.exec(statement))
+        {
+            qCWarning(lcCatalog) << "Catalog database schema couldn't be created:"
+                                 << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SqlProductStore::prepareView()
+{
+    QStringList conditions;
+    if (!mCurrency.isEmpty())
+    {
+        conditions.append("currency = :currency");
+    }
+    if (!mName.isEmpty())
+    {
+        conditions.append("name LIKE :name ESCAPE '\\'");
+    }
+    const QString where = conditions.isEmpty()
+            ? QString() : QStringLiteral(" WHERE ") + conditions.join(" AND ");
+    QString column = QStringLiteral("position");
+    switch (mOrder)
+    {
+    case NameOrder:
+        column = QStringLiteral("name");
+        break;
+    case CostOrder:
+        column = QStringLiteral("cost");
+        break;
+    case CurrencyOrder:
+        column = QStringLiteral("currency");
+        break;
+    default:
+        break;
+    }
+    QString order = QString(" ORDER BY %1 %2").arg(column)
+            .arg(mSortOrder == Qt::AscendingOrder ? "ASC" : "DESC");
+    if (mOrder != PositionOrder)
+    {
+        order += ", position";
+    }
+    QString namePattern = mName;
+    namePattern.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    namePattern += '%';
+
+    QSqlDatabase database = QSqlDatabase::database(mConnectionName);
+    mCountQuery = QSqlQuery(database);
+    mCountQuery.prepare("SELECT COUNT(*) FROM products" + where);
+    mReadQuery = QSqlQuery(database);
+    mReadQuery.setForwardOnly(true);
+    mReadQuery.prepare("SELECT image_name, name, cost, currency, description FROM products"
+                       + where + order + " LIMIT :count OFFSET :first");
+    mKeyQuery = QSqlQuery(database);
+    mKeyQuery.setForwardOnly(true);
+    mKeyQuery.prepare("SELECT id, position FROM products" + where + order
+                      + " LIMIT :count OFFSET :first");
+    for (QSqlQuery *query : {&mCountQuery, &mReadQuery, &mKeyQuery})
+    {
+        if (!mCurrency.isEmpty())
+        {
+            query->bindValue(":currency", mCurrency);
+        }
+        if (!mName.isEmpty())
+        {
+            query->bindValue(":name", namePattern);
+        }
+    }
+    mCount = -1;
+}
+
+bool SqlProductStore::exec(QSqlQuery &query) const
+{
+    if (!query.exec())
+    {
+        qCWarning(lcCatalog) << "Catalog database query failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void SqlProductStore::bindItem(QSqlQuery &query, const ProductItem &item)
+{
+    query.bindValue(":image_name", item.imageName());
+    query.bindValue(":name", item.name());
+    query.bindValue(":cost", item.cost());
+    query.bindValue(":currency", item.currency());
+    query.bindValue(":description", item.description());
+}
+
+QVector<qint64> SqlProductStore::ids(int first, int count)
+{
+    QVector<qint64> rowIds;
+    if (first < 0 || count <= 0)
+    {
+        return rowIds;
+    }
+    mKeyQuery.bindValue(":first", first);
+    mKeyQuery.bindValue(":count", count);
+    if (exec(mKeyQuery))
+    {
+        while (mKeyQuery.next())
+        {
+            rowIds.append(mKeyQuery.value(0).toLongLong());
+        }
+        mKeyQuery.finish();
+    }
+    return rowIds;
+}
+
+qint64 SqlProductStore::position(int row)
+{
+    qint64 rowPosition = -1;
+    mKeyQuery.bindValue(":first", row);
+    mKeyQuery.bindValue(":count", 1);
+    if (exec(mKeyQuery))
+    {
+        if (mKeyQuery.next())
+        {
+            rowPosition = mKeyQuery.value(1).toLongLong();
+        }
+        mKeyQuery.finish();
+    }
+    return rowPosition;
+}
+
+bool SqlProductStore::insertAt(qint64 position, const ProductItem &item)
+{
+    mInsertQuery.bindValue(":position", position);
+    bindItem(mInsertQuery, item);
+    return exec(mInsertQuery);
+}
@@ -0,0 +1,59 @@
+#ifndef SQLPRODUCTSTORE_H
+#define SQLPRODUCTSTORE_H
+
+#include "productstore.h"
+#include <QSqlQuery>
+
+class SqlProductStore : public ProductStore
+{
+public:
+    enum Order {
+        PositionOrder,
+        NameOrder,
+        CostOrder,
+        CurrencyOrder
+    };
+
+    explicit SqlProductStore(const QString &fileName);
+    ~SqlProductStore();
+
+    bool isValid() const;
+    int count() const override;
+    QVector<ProductItem> read(int first, int count) const override;
+
+    void setOrder(Order order, Qt::SortOrder sortOrder = Qt::AscendingOrder);
+    void setFilter(const QString &currency, const QString &name = QString());
+
+    bool insert(int row, const QVector<ProductItem> &items) override;
+    bool update(int row, const ProductItem &item) override;
+    bool remove(int row, int count) override;
+    bool hasStableRows() const override;
+    bool replace(const QVector<ProductItem> &items);
+
+private:
+    bool createSchema();
+    void prepareView();
+    bool exec(QSqlQuery &query) const;
+    void bindItem(QSqlQuery &query, const ProductItem &item);
+    QVector<qint64> ids(int first, int count);
+    qint64 position(int row);
+    bool insertAt(qint64 position, const ProductItem &item);
+
+    QString mConnectionName;
+    bool mIsValid;
+    Order mOrder;
+    Qt::SortOrder mSortOrder;
+    QString mCurrency;
+    QString mName;
+    mutable int mCount;
+    mutable QSqlQuery mCountQuery;
+    mutable QSqlQuery mReadQuery;
+    QSqlQuery mKeyQuery;
+    QSqlQuery mLastPositionQuery;
+    QSqlQuery mShiftQuery;
+    QSqlQuery mInsertQuery;
+    QSqlQuery mRemoveQuery;
+    QSqlQuery mUpdateQuery;
+};
+
+#endif // SQLPRODUCTSTORE_H
@@ -0,0 +1,236 @@
+#include "statuspoller.h"
+#include "logger.h"
+
+#include <QTimerEvent>
+#include <qmath.h>
+
+static const int scInitialInterval = 500;
+static const int scMaxInterval = 5000;
+static const double scMultiplier = 1.5;
+static const double scJitter = 0.2;
+static const int scDeadline = 120000;
+
+StatusPoller::StatusPoller(QObject *parent)
+    : QObject(parent)
+    ,mInitialInterval(scInitialInterval)
+    ,mMaxInterval(scMaxInterval)
+    ,mMultiplier(scMultiplier)
+    ,mJitter(scJitter)
+    ,mDeadline(scDeadline)
+{
+}
+
+void StatusPoller::setInitialInterval(int msec)
+{
+    mInitialInterval = qMax(0, msec);
+}
+
+int StatusPoller::initialInterval() const
+{
+    return mInitialInterval;
+}
+
+void StatusPoller::setMaxInterval(int msec)
+{
+    mMaxInterval = qMax(0, msec);
+}
+
+int StatusPoller::maxInterval() const
+{
+    return mMaxInterval;
+}
+
+void StatusPoller::setMultiplier(double multiplier)
+{
+    mMultiplier = qMax(1.0, multiplier);
+}
+
+double StatusPoller::multiplier() const
+{
+    return mMultiplier;
+}
+
+void StatusPoller::setJitter(double jitter)
+{
+    mJitter = qBound(0.0, jitter, 1.0);
+}
+
+double StatusPoller::jitter() const
+{
+    return mJitter;
+}
+
+void StatusPoller::setDeadline(int msec)
+{
+    mDeadline = msec;
+}
+
+int StatusPoller::deadline() const
+{
+    return mDeadline;
+}
+
+void StatusPoller::start(const QString &pid)
+{
+    if (pid.isEmpty())
+    {
+        return;
+    }
+    cancelAll();
+    mPolls.clear();
+    Poll poll;
+    poll.timerId = -1;
+    poll.attempt = 0;
+    poll.pollCount = 0;
+    poll.suspended = false;
+    poll.elapsed.start();
+    mPolls.insert(pid, poll);
+    this->poll(pid);
+}
+
+void StatusPoller::next(const QString &pid)
+{
+    if (!isActive(pid))
+    {
+        return;
+    }
+    Poll &poll = mPolls[pid];
+    if (poll.timerId != -1 || poll.suspended)
+    {
+        return;
+    }
+    const qint64 remaining = mDeadline > 0 ? mDeadline - poll.elapsed.elapsed() : mMaxInterval;
+    if (remaining <= 0)
+    {
+        qCInfo(lcStatus) << "Deadline expired for" << pid << "after" << poll.pollCount
+                         << "polls.";
+        finish(pid);
+        emit deadlineExpired(pid);
+        return;
+    }
+    const int interval = static_cast<int>(qMin<qint64>(nextInterval(poll.attempt), remaining));
+    ++poll.attempt;
+    poll.timerId = startTimer(interval);
+    mTimers.insert(poll.timerId, pid);
+}
+
+void StatusPoller::stop(const QString &pid)
+{
+    if (isActive(pid))
+    {
+        qCDebug(lcStatus) << "Status of" << pid << "received after"
+                          << mPolls.value(pid).pollCount << "polls.";
+        finish(pid);
+    }
+}
+
+void StatusPoller::suspend(const QString &pid)
+{
+    if (isActive(pid) && !mPolls.value(pid).suspended)
+    {
+        Poll &poll = mPolls[pid];
+        killPollTimer(poll);
+        poll.suspended = true;
+        if (mDeadline > 0)
+        {
+            // The timer only guards the deadline while the status is delivered by other means.
+            const int remaining = mDeadline - static_cast<int>(poll.elapsed.elapsed());
+            poll.timerId = startTimer(qMax(0, remaining));
+            mTimers.insert(poll.timerId, pid);
+        }
+    }
+}
+
+void StatusPoller::resume(const QString &pid)
+{
+    if (isActive(pid) && mPolls.value(pid).suspended)
+    {
+        Poll &poll = mPolls[pid];
+        killPollTimer(poll);
+        poll.suspended = false;
+        this->poll(pid);
+    }
+}
+
+void StatusPoller::cancel(const QString &pid)
+{
+    if (isActive(pid))
+    {
+        finish(pid);
+        emit cancelled(pid);
+    }
+}
+
+void StatusPoller::cancelAll()
+{
+    const QStringList pids = mPolls.keys();
+    for (const QString &pid : pids)
+    {
+        cancel(pid);
+    }
+}
+
+bool StatusPoller::isActive(const QString &pid) const
+{
+    return mPolls.contains(pid) && mPolls.value(pid).elapsed.isValid();
+}
+
+int StatusPoller::pollCount(const QString &pid) const
+{
+    return mPolls.value(pid).pollCount;
+}
+
+void StatusPoller::timerEvent(QTimerEvent *event)
+{
+    const QString pid = mTimers.take(event->timerId());
+    killTimer(event->timerId());
+    if (isActive(pid))
+    {
+        Poll &poll = mPolls[pid];
+        poll.timerId = -1;
+        if (poll.suspended)
+        {
+            qCInfo(lcStatus) << "Deadline expired for" << pid << "while suspended.";
+            finish(pid);
+            emit deadlineExpired(pid);
+        }
+        else
+        {
+            this->poll(pid);
+        }
+    }
+}
+
+int StatusPoller::nextInterval(int attempt) const
+{
+    double interval = qMin<double>(mInitialInterval * qPow(mMultiplier, attempt), mMaxInterval);
+    if (mJitter > 0.0)
+    {
+        const double random = (2.0 * qrand() / RAND_MAX) - 1.0;
+        interval += interval * mJitter * random;
+    }
+    return qMax(0, qRound(interval));
+}
+
+void StatusPoller::poll(const QString &pid)
+{
+    ++mPolls[pid].pollCount;
+    emit pollRequested(pid);
+}
+
+void StatusPoller::killPollTimer(Poll &poll)
+{
+    if (poll.timerId != -1)
+    {
+        killTimer(poll.timerId);
+        mTimers.remove(poll.timerId);
+        poll.timerId = -1;
+    }
+}
+
+void StatusPoller::finish(const QString &pid)
+{
+    Poll &poll = mPolls[pid];
+    killPollTimer(poll);
+    poll.elapsed.invalidate();
+}
@@ -0,0 +1,72 @@
+#ifndef STATUSPOLLER_H
+#define STATUSPOLLER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QHash>
+
+class StatusPoller : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StatusPoller(QObject *parent = nullptr);
+
+    void setInitialInterval(int msec);
+    int initialInterval() const;
+
+    void setMaxInterval(int msec);
+    int maxInterval() const;
+
+    void setMultiplier(double multiplier);
+    double multiplier() const;
+
+    void setJitter(double jitter);
+    double jitter() const;
+
+    void setDeadline(int msec);
+    int deadline() const;
+
+    void start(const QString &pid);
+    void next(const QString &pid);
+    void stop(const QString &pid);
+    void suspend(const QString &pid);
+    void resume(const QString &pid);
+    void cancel(const QString &pid);
+    void cancelAll();
+
+    bool isActive(const QString &pid) const;
+    int pollCount(const QString &pid) const;
+
+signals:
+    void pollRequested(const QString &pid);
+    void deadlineExpired(const QString &pid);
+    void cancelled(const QString &pid);
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    struct Poll
+    {
+        int timerId;
+        int attempt;
+        int pollCount;
+        bool suspended;
+        QElapsedTimer elapsed;
+    };
+
+    int nextInterval(int attempt) const;
+    void poll(const QString &pid);
+    void killPollTimer(Poll &poll);
+    void finish(const QString &pid);
+
+    QHash<QString, Poll> mPolls;
+    QHash<int, QString> mTimers;
+    int mInitialInterval;
+    int mMaxInterval;
+    double mMultiplier;
+    double mJitter;
+    int mDeadline;
+};
+
+#endif // STATUSPOLLER_H
@@ -0,0 +1,255 @@
+#include "thumbnailimageprovider.h"
+#include "logger.h"
+
+#include <QCryptographicHash>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QRunnable>
+#include <QThread>
+#include <QDataStream>
+#include <QBuffer>
+#include <QDir>
+
+static const int scDefaultThumbnailSize = 128;
+static const int scThumbnailQuality = 85;
+static const QString scThumbnailName("%1_%2x%3");
+static const QString scIndexFile("hashes.idx");
+static const quint32 scIndexFormat = 1;
+static const int scIndexSaveBatch = 16;
+
+namespace {
+class ThumbnailResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+    ThumbnailResponse(ThumbnailImageProvider *provider, const QString &id, const QSize &size)
+        : mProvider(provider)
+        ,mId(id)
+        ,mSize(size)
+    {
+        // The engine owns the response, the pool must not delete it.
+        setAutoDelete(false);
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(mImage);
+    }
+
+    QString errorString() const override
+    {
+        return mImage.isNull() ? QStringLiteral("Thumbnail couldn't be created for ") + mId
+                               : QString();
+    }
+
+    void cancel() override
+    {
+        mIsCanceled.store(1);
+    }
+
+    void run() override
+    {
+        if (!mIsCanceled.load())
+        {
+            mImage = mProvider->thumbnail(mId, mSize);
+        }
+        emit finished();
+    }
+
+private:
+    ThumbnailImageProvider *mProvider;
+    QString mId;
+    QSize mSize;
+    QImage mImage;
+    QAtomicInt mIsCanceled;
+};
+}
+
+ThumbnailImageProvider::ThumbnailImageProvider(const QString &imagePath,
+                                               const QString &cachePath)
+    : QQuickAsyncImageProvider()
+    ,mImagePath(imagePath)
+    ,mCachePath(cachePath)
+    ,mUnsavedHashCount(0)
+{
+    QDir().mkpath(mCachePath);
+    loadIndex();
+    // Leave a core to the GUI and render threads.
+    mPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+ThumbnailImageProvider::~ThumbnailImageProvider()
+{
+    mPool.waitForDone();
+    QMutexLocker locker(&mMutex);
+    if (mUnsavedHashCount > 0)
+    {
+        saveIndex();
+    }
+}
+
+QQuickImageResponse *ThumbnailImageProvider::requestImageResponse(const QString &id,
+                                                                  const QSize &requestedSize)
+{
+    ThumbnailResponse *response = new ThumbnailResponse(this, id, requestedSize);
+    mPool.start(response);
+    return response;
+}
+
+QImage ThumbnailImageProvider::thumbnail(const QString &id, const QSize &requestedSize)
+{
+    const QSize size(requestedSize.width() > 0 ? requestedSize.width() : scDefaultThumbnailSize,
+                     requestedSize.height() > 0 ? requestedSize.height()
+                                                : scDefaultThumbnailSize);
+    const QFileInfo source(QDir(mImagePath).filePath(QFileInfo(id).fileName()));
+    if (!source.exists())
+    {
+        return QImage();
+    }
+
+    // Photos are keyed by their content, so a photo picked twice shares its thumbnails. The
+    // hash is remembered per file state, a known photo is served without reading it again.
+    QByteArray hash;
+    {
+        QMutexLocker locker(&mMutex);
+        QHash<QString, FileStamp>::const_iterator it = mHashes.constFind(source.fileName());
+        if (it != mHashes.constEnd() && it->modified == source.lastModified()
+                && it->size == source.size())
+        {
+            hash = it->hash;
+        }
+    }
+    QByteArray data;
+    if (hash.isEmpty())
+    {
+        QFile file(source.filePath());
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return QImage();
+        }
+        data = file.readAll();
+        hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+        QMutexLocker locker(&mMutex);
+        mHashes.insert(source.fileName(), {source.lastModified(), source.size(), hash});
+        // The index is saved in batches, photos hashed since the last save are only read again
+        // if the application is killed.
+        if (++mUnsavedHashCount >= scIndexSaveBatch)
+        {
+            saveIndex();
+        }
+    }
+
+    const QString cacheFile = QDir(mCachePath).filePath(
+                scThumbnailName.arg(QString::fromLatin1(hash)).arg(size.width())
+                .arg(size.height()));
+    QImage image(cacheFile);
+    if (!image.isNull())
+    {
+        return image;
+    }
+    if (data.isEmpty())
+    {
+        QFile file(source.filePath());
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return QImage();
+        }
+        data = file.readAll();
+    }
+    image = decode(data, size);
+    if (!image.isNull())
+    {
+        QSaveFile saveFile(cacheFile);
+        if (!saveFile.open(QIODevice::WriteOnly)
+                || !image.save(&saveFile, image.hasAlphaChannel() ? "PNG" : "JPG",
+                               scThumbnailQuality)
+                || !saveFile.commit())
+        {
+            qCWarning(lcImages) << "Thumbnail couldn't be cached to" << cacheFile;
+        }
+    }
+    return image;
+}
+
+QImage ThumbnailImageProvider::decode(const QByteArray &data, const QSize &size) const
+{
+    // Decoding straight to the thumbnail size lets the JPEG decoder skip most of the full
+    // resolution work and never allocates the full size image.
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    reader.setAutoTransform(true);
+    const QSize imageSize = reader.size();
+    if (imageSize.isValid())
+    {
+        reader.setScaledSize(imageSize.scaled(size, Qt::KeepAspectRatioByExpanding)
+                             .boundedTo(imageSize));
+    }
+    QImage image = reader.read();
+    if (image.isNull())
+    {
+        qCWarning(lcImages) << "Product image couldn't be decoded:" << reader.errorString();
+    }
+    return image;
+}
+
+void ThumbnailImageProvider::loadIndex()
+{
+    QFile file(QDir(mCachePath).filePath(scIndexFile));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    quint32 format = 0;
+    quint32 count = 0;
+    stream >> format >> count;
+    if (format != scIndexFormat)
+    {
+        qCWarning(lcImages) << "Photo hash index has unknown format" << format;
+        return;
+    }
+    QHash<QString, FileStamp> hashes;
+    hashes.reserve(static_cast<int>(count));
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString fileName;
+        qint64 modified = 0;
+        FileStamp stamp;
+        stream >> fileName >> modified >> stamp.size >> stamp.hash;
+        stamp.modified = QDateTime::fromMSecsSinceEpoch(modified);
+        hashes.insert(fileName, stamp);
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        qCWarning(lcImages) << "Photo hash index is truncated, photos are hashed again.";
+        return;
+    }
+    mHashes = hashes;
+}
+
+void ThumbnailImageProvider::saveIndex()
+{
+    QSaveFile file(QDir(mCachePath).filePath(scIndexFile));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(lcImages) << "Photo hash index couldn't be saved:" << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << scIndexFormat << static_cast<quint32>(mHashes.count());
+    for (QHash<QString, FileStamp>::const_iterator it = mHashes.constBegin();
+         it != mHashes.constEnd(); ++it)
+    {
+        stream << it.key() << it->modified.toMSecsSinceEpoch() << it->size << it->hash;
+    }
+    if (!file.commit())
+    {
+        qCWarning(lcImages) << "Photo hash index couldn't be saved:" << file.errorString();
+        return;
+    }
+    mUnsavedHashCount = 0;
+}
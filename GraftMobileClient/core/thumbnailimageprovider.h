@@ -0,0 +1,43 @@
+#ifndef THUMBNAILIMAGEPROVIDER_H
+#define THUMBNAILIMAGEPROVIDER_H
+
+#include <QQuickAsyncImageProvider>
+#include <QDateTime>
+#include <QThreadPool>
+#include <QMutex>
+#include <QHash>
+
+class ThumbnailImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    ThumbnailImageProvider(const QString &imagePath, const QString &cachePath);
+    ~ThumbnailImageProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id,
+                                              const QSize &requestedSize) override;
+
+    QImage thumbnail(const QString &id, const QSize &requestedSize);
+
+private:
+    struct FileStamp
+    {
+        QDateTime modified;
+        qint64 size;
+        QByteArray hash;
+    };
+
+    QImage decode(const QByteArray &data, const QSize &size) const;
+    void loadIndex();
+    // Called with mMutex held.
+    void saveIndex();
+
+    QString mImagePath;
+    QString mCachePath;
+    QThreadPool mPool;
+    QMutex mMutex;
+    // Hashes of the photos by file name, kept in the cache so a cold start doesn't read them.
+    QHash<QString, FileStamp> mHashes;
+    int mUnsavedHashCount;
+};
+
+#endif // THUMBNAILIMAGEPROVIDER_H
@@ -14,7 +14,10 @@
 #include "core/graftwalletclient.h"
 #include "core/quickexchangemodel.h"
 #include "core/selectedproductproxymodel.h"
+#include "core/productsearchmodel.h"
+#include "core/pagedproductmodel.h"
 #include "core/defines.h"
+#include "core/logger.h"
 #include "designfactory.h"
 
 #ifdef POS_BUILD
@@ -35,6 +38,7 @@ int main(int argc, char *argv[])
 
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QGuiApplication app(argc, argv);
+    Logger::install();
     QQmlApplicationEngine engine;
     DesignFactory factory;
     factory.registrate(engine.rootContext());
@@ -64,6 +68,8 @@ int main(int argc, char *argv[])
     engine.rootContext()->setContextProperty(QStringLiteral("SelectedProductModel"),
                                              client.selectedProductModel());
     engine.rootContext()->setContextProperty(QStringLiteral("ProductModel"), client.productModel());
+    engine.rootContext()->setContextProperty(QStringLiteral("ProductSearchModel"),
+                                             client.productSearchModel());
     engine.rootContext()->setContextProperty(QStringLiteral("GraftClient"), &client);
     engine.load(QUrl(QLatin1String("qrc:/pos/main.qml")));
 #endif
@@ -10,6 +10,8 @@ SwipeDelegate {
     signal removeItemClicked()
     signal editItemClicked()
 
+    // Row of the product in ProductModel, differs from index in lists of search results.
+    property int productRow: index
     property bool selectState: false
     property bool visibleCheckBox: true
     property alias productPriceTextColor: selectedProductDelegate.productPriceTextColor
@@ -33,7 +35,7 @@ SwipeDelegate {
     onPressed: forceActiveFocus()
 
     onClicked: {
-        ProductModel.changeSelection(index)
+        ProductModel.changeSelection(productRow)
         swipe.close()
     }
 
@@ -1,4 +1,5 @@
 import QtQuick 2.9
+import QtQuick.Window 2.2
 import QtQuick.Layouts 1.3
 import QtQuick.Controls 2.2
 import org.graft 1.0
@@ -57,13 +58,23 @@ BaseScreen {
             Image {
                 id: qrCodeImage
                 cache: false
+                smooth: false
                 height: parent.height - 20
                 width: height
+                sourceSize {
+                    width: Math.round(qrCodeImage.width * Screen.devicePixelRatio)
+                    height: Math.round(qrCodeImage.height * Screen.devicePixelRatio)
+                }
                 anchors {
                     centerIn: parent
                     margins: 10
                 }
 
+                BusyIndicator {
+                    anchors.centerIn: parent
+                    running: qrCodeImage.status === Image.Loading
+                }
+
                 Rectangle {
                     id: temporaryLabel
                     anchors.centerIn: parent
@@ -1,4 +1,5 @@
 import QtQuick 2.9
+import QtQuick.Window 2.2
 import QtQuick.Layouts 1.3
 import QtQuick.Controls 2.2
 import QtQuick.Controls.Material 2.2
@@ -22,12 +23,23 @@ BaseCartScreen {
             spacing: 11
 
             Image {
+                id: qrCodeImage
                 cache: false
+                smooth: false
+                sourceSize {
+                    width: Math.round(qrCodeImage.Layout.preferredHeight * Screen.devicePixelRatio)
+                    height: Math.round(qrCodeImage.Layout.preferredHeight * Screen.devicePixelRatio)
+                }
                 source: GraftClient.qrCodeImage()
                 Layout.alignment: Qt.AlignCenter
                 Layout.preferredHeight: 160
                 Layout.preferredWidth: height
                 Layout.topMargin: 10
+
+                BusyIndicator {
+                    anchors.centerIn: parent
+                    running: qrCodeImage.status === Image.Loading
+                }
             }
 
             Text {
@@ -65,7 +77,7 @@ BaseCartScreen {
                                 height: 70
                                 topLineVisible: false
                                 bottomLineVisible: false
-                                productImage: imagePath
+                                productImage: thumbnailPath
                                 productPrice: cost
                                 productPriceTextColor: ColorFactory.color(
                                                            DesignFactory.ItemText)
@@ -42,6 +42,17 @@ BaseScreen {
             spacing: 0
             anchors.fill: parent
 
+            TextField {
+                id: searchField
+                Layout.fillWidth: true
+                Layout.leftMargin: 15
+                Layout.rightMargin: 15
+                placeholderText: qsTr("Search")
+                inputMethodHints: Qt.ImhNoPredictiveText
+                Component.onCompleted: text = ProductSearchModel.query
+                onTextChanged: ProductSearchModel.query = text
+            }
+
             Rectangle {
                 Layout.fillWidth: true
                 Layout.fillHeight: true
@@ -51,7 +62,7 @@ BaseScreen {
                     id: productList
                     spacing: 0
                     clip: true
-                    model: ProductModel
+                    model: ProductSearchModel
                     delegate: productDelegate
                     anchors.fill: parent
 
@@ -60,10 +71,11 @@ BaseScreen {
                         ProductSwipeDelegate {
                             width: productList.width
                             height: 60
+                            productRow: sourceRow
                             selectState: selected
                             bottomLineVisible: false
                             topLineVisible: false
-                            productImage: imagePath
+                            productImage: thumbnailPath
                             productPrice: cost
                             productPriceTextColor: ColorFactory.color(DesignFactory.ItemText)
                             productText {
@@ -78,12 +90,12 @@ BaseScreen {
                                 text: qsTr("Are you sure that you want to remove this item?")
                                 standardButtons: StandardButton.Yes | StandardButton.No
                                 onYes: {
-                                    ProductModel.removeProduct(index)
+                                    ProductModel.removeProduct(productRow)
                                     GraftClient.saveProducts()
                                 }
                             }
                             onRemoveItemClicked: messageDialog.open()
-                            onEditItemClicked: pushScreen.openEditingItemScreen(index)
+                            onEditItemClicked: pushScreen.openEditingItemScreen(productRow)
                         }
                     }
                 }
@@ -105,7 +117,7 @@ BaseScreen {
                 Layout.rightMargin: 15
                 enabled: GraftClient.networkType() === GraftClientTools.PublicExperimentalTestnet
                 onClicked: {
-                    if (ProductModel.totalCost() > 0) {
+                    if (ProductModel.totalCost > 0) {
                         GraftClient.sale()
                     } else {
                         screenDialog.text = qsTr("Please, select one or more products to continue.")
@@ -1,4 +1,5 @@
 import QtQuick 2.9
+import QtQuick.Window 2.2
 import QtQuick.Layouts 1.3
 import QtQuick.Controls 2.2
 import QtQuick.Controls.Material 2.2
@@ -28,12 +29,23 @@ BaseCartScreen {
             spacing: 0
 
             Image {
+                id: qrCodeImage
                 cache: false
+                smooth: false
+                sourceSize {
+                    width: Math.round(qrCodeImage.Layout.preferredHeight * Screen.devicePixelRatio)
+                    height: Math.round(qrCodeImage.Layout.preferredHeight * Screen.devicePixelRatio)
+                }
                 source: GraftClient.qrCodeImage()
                 Layout.alignment: Qt.AlignCenter
                 Layout.preferredHeight: 180
                 Layout.preferredWidth: height
                 Layout.topMargin: 25
+
+                BusyIndicator {
+                    anchors.centerIn: parent
+                    running: qrCodeImage.status === Image.Loading
+                }
             }
 
             Text {
@@ -62,7 +74,7 @@ BaseCartScreen {
                         width: productList.width
                         height: 60
                         bottomLineVisible: index === (productList.count - 1)
-                        productImage: imagePath
+                        productImage: thumbnailPath
                         productPrice: cost
                         productPriceTextColor: ColorFactory.color(
                                                    DesignFactory.ItemText)
@@ -33,7 +33,7 @@ BaseStackViewer {
 
     function openCartScreen() {
         stack.push("qrc:/pos/CartScreen.qml", {"pushScreen": posTransitions(),
-                   "price": ProductModel.totalCost()})
+                   "price": ProductModel.totalCost})
     }
 
     function clearChecked() {